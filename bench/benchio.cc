@@ -0,0 +1,738 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bit_packed.h"
+#include "block_index.h"
+#include "decode.h"
+#include "decode_iterator.h"
+#include "delta.h"
+#include "encode.h"
+#include "encode_writer.h"
+#include "group_varint.h"
+#include "kernel.h"
+#include "mapped_decoder.h"
+#include "padded.h"
+#include "parallel.h"
+#include "record.h"
+#include "sorted_view.h"
+#include "string_codec.h"
+
+static auto generate(const std::size_t size,
+                     const std::initializer_list<double> weights)
+    -> std::vector<std::uint64_t>;
+template <class Function>
+static void measure(const std::string &name, const std::size_t size,
+                    Function function);
+
+int main(int argc, char **argv) {
+  const std::size_t size{argc > 1 ? std::strtoull(argv[1], nullptr, 10)
+                                  : 1ull << 22ull};
+  const std::vector<std::uint64_t> xs{
+      generate(size, {60.0, 25.0, 10.0, 4.0, 1.0})};
+  std::string encoded{};
+
+  {
+    std::ostringstream os{};
+
+    for (const auto &x : xs)
+      lttoolbox::encode(os, x);
+
+    encoded = os.str();
+  }
+
+  std::cout << size << " values, " << encoded.size() << " bytes, kernels "
+            << lttoolbox::get_name(
+                   lttoolbox::get_kernel(lttoolbox::Operation::decode))
+            << " for decoding and "
+            << lttoolbox::get_name(
+                   lttoolbox::get_kernel(lttoolbox::Operation::encode))
+            << " for encoding\n";
+
+  measure("encode stream", size, [&]() -> std::uint64_t {
+    std::ostringstream os{};
+
+    for (const auto &x : xs)
+      lttoolbox::encode(os, x);
+
+    return os.tellp();
+  });
+
+  std::vector<char> s(9ull * size);
+
+  measure("encode buffer", size, [&]() -> std::uint64_t {
+    char *last{s.data()};
+
+    for (const auto &x : xs)
+      last = lttoolbox::encode(last, x);
+
+    return last - s.data();
+  });
+
+  measure("encode EncodeWriter stream", size, [&]() -> std::uint64_t {
+    std::ostringstream os{};
+
+    {
+      lttoolbox::EncodeWriter writer{os};
+
+      for (const auto &x : xs)
+        writer.encode(x);
+    }
+
+    return os.tellp();
+  });
+
+  measure("encode EncodeWriter string", size, [&]() -> std::uint64_t {
+    std::string t{};
+
+    {
+      lttoolbox::EncodeWriter writer{t};
+
+      for (const auto &x : xs)
+        writer.encode(x);
+    }
+
+    return t.size();
+  });
+
+  measure("encode EncodeOutputIterator", size, [&]() -> std::uint64_t {
+    std::string t{};
+
+    {
+      lttoolbox::EncodeWriter writer{t};
+      std::copy(xs.cbegin(), xs.cend(),
+                lttoolbox::EncodeOutputIterator{writer});
+    }
+
+    return t.size();
+  });
+
+  measure("decode stream", size, [&]() -> std::uint64_t {
+    std::istringstream is{encoded};
+    std::uint64_t x{0ull};
+    std::uint64_t sum{0ull};
+
+    for (std::size_t i{0ull}; i != size; ++i) {
+      lttoolbox::decode(is, x);
+      sum += x;
+    }
+
+    return sum;
+  });
+
+  measure("decode buffer", size, [&]() -> std::uint64_t {
+    const char *first{encoded.data()};
+    const char *const last{first + encoded.size()};
+    std::uint64_t x{0ull};
+    std::uint64_t sum{0ull};
+
+    for (std::size_t i{0ull}; i != size; ++i) {
+      first = lttoolbox::decode(first, last, x);
+      sum += x;
+    }
+
+    return sum;
+  });
+
+  measure("decode DecodedRange stream", size, [&]() -> std::uint64_t {
+    std::istringstream is{encoded};
+    lttoolbox::DecodedRange range{is};
+    return std::accumulate(range.begin(), range.end(), std::uint64_t{0ull});
+  });
+
+  measure("decode DecodedRange buffer", size, [&]() -> std::uint64_t {
+    lttoolbox::DecodedRange range{encoded.data(),
+                                  encoded.data() + encoded.size()};
+    return std::accumulate(range.begin(), range.end(), std::uint64_t{0ull});
+  });
+
+  std::vector<std::uint64_t> decoded(size);
+
+  {
+    char path[]{"/tmp/benchio.XXXXXX"};
+    const int fd{mkstemp(path)};
+
+    {
+      lttoolbox::EncodeWriter writer{fd};
+      writer.encode_range(xs.data(), xs.data() + xs.size());
+    }
+
+    close(fd);
+
+    measure("decode ifstream", size, [&]() -> std::uint64_t {
+      std::ifstream is{path, std::ios::binary};
+      std::uint64_t x{0ull};
+      std::uint64_t sum{0ull};
+
+      for (std::size_t i{0ull}; i != size; ++i) {
+        lttoolbox::decode(is, x);
+        sum += x;
+      }
+
+      return sum;
+    });
+
+    measure("decode MappedDecoder", size, [&]() -> std::uint64_t {
+      lttoolbox::MappedDecoder decoder{path};
+      decoder.decode_n(decoded.data(), size);
+      std::uint64_t sum{0ull};
+
+      for (const auto &x : decoded)
+        sum += x;
+
+      return sum;
+    });
+
+    std::remove(path);
+  }
+
+  // Symbol streams, which are almost all in the 0th and 1st classes.
+  const std::vector<std::uint64_t> symbols{generate(size, {80.0, 20.0})};
+  std::string encoded_symbols{};
+
+  {
+    std::ostringstream os{};
+
+    for (const auto &x : symbols)
+      lttoolbox::encode(os, x);
+
+    encoded_symbols = os.str();
+  }
+
+  measure("decode symbols buffer", size, [&]() -> std::uint64_t {
+    const char *first{encoded_symbols.data()};
+    const char *const last{first + encoded_symbols.size()};
+    std::uint64_t x{0ull};
+    std::uint64_t sum{0ull};
+
+    for (std::size_t i{0ull}; i != size; ++i) {
+      first = lttoolbox::decode(first, last, x);
+      sum += x;
+    }
+
+    return sum;
+  });
+
+  const lttoolbox::PaddedBuffer padded{encoded.data(),
+                                      encoded.data() + encoded.size()};
+
+  measure("decode_n_padded", size, [&]() -> std::uint64_t {
+    lttoolbox::decode_n_padded(padded, decoded.data(), size);
+    std::uint64_t sum{0ull};
+
+    for (const auto &x : decoded)
+      sum += x;
+
+    return sum;
+  });
+
+  const lttoolbox::PaddedBuffer padded_symbols{
+      encoded_symbols.data(), encoded_symbols.data() + encoded_symbols.size()};
+
+  measure("decode_n_padded symbols", size, [&]() -> std::uint64_t {
+    lttoolbox::decode_n_padded(padded_symbols, decoded.data(), size);
+    std::uint64_t sum{0ull};
+
+    for (const auto &x : decoded)
+      sum += x;
+
+    return sum;
+  });
+
+  {
+    const char *const first{encoded.data()};
+    const char *const last{first + encoded.size()};
+    const lttoolbox::BlockIndex index{first, last, 4096ull};
+
+    std::vector<char> t(lttoolbox::encoded_size(xs.data(), xs.data() + size));
+
+    measure("encode_parallel", size, [&]() -> std::uint64_t {
+      return lttoolbox::encode_parallel(t.data(), xs.data(),
+                                        xs.data() + size) -
+             t.data();
+    });
+
+    measure("decode_parallel", size, [&]() -> std::uint64_t {
+      std::size_t n{0ull};
+      lttoolbox::decode_parallel(first, last, decoded.data(), n);
+      return decoded[n - 1ull];
+    });
+
+    measure("decode_parallel index", size, [&]() -> std::uint64_t {
+      lttoolbox::decode_parallel(first, last, index, decoded.data());
+      return decoded.back();
+    });
+  }
+
+  // Random lookups of single values, with a block index and by scanning from
+  // the start.  Scanning is so slow that it is measured with fewer lookups.
+  {
+    const char *const first{encoded.data()};
+    const char *const last{first + encoded.size()};
+    const lttoolbox::BlockIndex index{first, last};
+    std::mt19937_64 engine{0x5eedull};
+    std::vector<std::size_t> ks(1024ull);
+
+    for (auto &k : ks)
+      k = engine() % size;
+
+    measure("seek_to_value", ks.size(), [&]() -> std::uint64_t {
+      std::uint64_t sum{0ull};
+
+      for (const auto &k : ks) {
+        std::uint64_t x{0ull};
+        lttoolbox::decode(lttoolbox::seek_to_value(first, last, index, k),
+                          last, x);
+        sum += x;
+      }
+
+      return sum;
+    });
+
+    measure("scan to value", 16ull, [&]() -> std::uint64_t {
+      std::uint64_t sum{0ull};
+
+      for (auto k = ks.cbegin(); k != ks.cbegin() + 16; ++k) {
+        const char *s{first};
+        std::uint64_t x{0ull};
+
+        for (std::size_t i{0ull}; i <= *k; ++i)
+          s = lttoolbox::decode(s, last, x);
+
+        sum += x;
+      }
+
+      return sum;
+    });
+  }
+
+  // Sorted lists, like transition targets, whose gaps are mostly in the 0th
+  // class.
+  std::vector<std::uint64_t> sorted{generate(size, {90.0, 10.0})};
+  std::partial_sum(sorted.cbegin(), sorted.cend(), sorted.begin());
+  char *const sorted_last{
+      lttoolbox::encode_n(s.data(), sorted.data(), size)};
+  const std::string encoded_sorted{s.data(), sorted_last};
+  char *const delta_last{
+      lttoolbox::encode_delta(s.data(), sorted.data(), size)};
+  const std::string encoded_delta{s.data(), delta_last};
+  std::cout << "sorted: " << encoded_sorted.size() << " bytes, delta: "
+            << encoded_delta.size() << " bytes\n";
+
+  measure("decode_n sorted", size, [&]() -> std::uint64_t {
+    lttoolbox::decode_n(encoded_sorted.data(),
+                        encoded_sorted.data() + encoded_sorted.size(),
+                        decoded.data(), size);
+    return decoded.back();
+  });
+
+  measure("decode_delta", size, [&]() -> std::uint64_t {
+    std::vector<std::uint64_t> xs{};
+    xs.reserve(size);
+    lttoolbox::decode_delta(encoded_delta.data(),
+                            encoded_delta.data() + encoded_delta.size(), xs);
+    return xs.back();
+  });
+
+  measure("DeltaIterator", size, [&]() -> std::uint64_t {
+    std::uint64_t sum{0ull};
+
+    for (lttoolbox::DeltaIterator it{encoded_delta.data(),
+                                     encoded_delta.data() +
+                                         encoded_delta.size()};
+         it != lttoolbox::DeltaIterator{}; ++it)
+      sum += *it;
+
+    return sum;
+  });
+
+  // Membership tests in the sorted list, with a searchable sequence and by
+  // decoding the delta sequence until the value is reached.
+  {
+    std::vector<char> t(lttoolbox::get_sorted_capacity(size, 128ull));
+    const lttoolbox::SortedView view{
+        t.data(), lttoolbox::encode_sorted(t.data(), sorted.data(), size)};
+    std::cout << "searchable: " << view.tell() - t.data() << " bytes\n";
+    std::mt19937_64 engine{0x5eedull};
+    std::vector<std::uint64_t> ys(1024ull);
+
+    for (auto &y : ys)
+      y = engine() % sorted.back();
+
+    measure("SortedView contains", ys.size(), [&]() -> std::uint64_t {
+      std::uint64_t count{0ull};
+
+      for (const auto &y : ys)
+        count += view.contains(y);
+
+      return count;
+    });
+
+    measure("DeltaIterator contains", 16ull, [&]() -> std::uint64_t {
+      std::uint64_t count{0ull};
+
+      for (auto y = ys.cbegin(); y != ys.cbegin() + 16; ++y) {
+        lttoolbox::DeltaIterator it{encoded_delta.data(),
+                                    encoded_delta.data() +
+                                        encoded_delta.size()};
+
+        for (; it != lttoolbox::DeltaIterator{} && *it < *y; ++it)
+          ;
+
+        count += it != lttoolbox::DeltaIterator{} && *it == *y;
+      }
+
+      return count;
+    });
+  }
+
+  // Transitions of (input symbol, output symbol, target state, weight), one
+  // per value.
+  {
+    std::string encoded_transitions{};
+
+    measure("transitions encode", size, [&]() -> std::uint64_t {
+      std::ostringstream os{};
+
+      for (const auto &x : symbols) {
+        lttoolbox::encode(os, static_cast<std::uint32_t>(x));
+        lttoolbox::encode(os, static_cast<std::uint32_t>(x >> 1u));
+        lttoolbox::encode(os, x);
+        lttoolbox::encode(os, static_cast<double>(x & 3ull));
+      }
+
+      encoded_transitions = os.str();
+      return encoded_transitions.size();
+    });
+
+    measure("transitions encode_record", size, [&]() -> std::uint64_t {
+      std::ostringstream os{};
+
+      for (const auto &x : symbols)
+        lttoolbox::encode_record(
+            os, std::make_tuple(static_cast<std::uint32_t>(x),
+                                static_cast<std::uint32_t>(x >> 1u), x,
+                                static_cast<double>(x & 3ull)));
+
+      return os.str().size();
+    });
+
+    measure("transitions decode", size, [&]() -> std::uint64_t {
+      std::istringstream is{encoded_transitions};
+      std::uint32_t input{0u};
+      std::uint32_t output{0u};
+      std::uint64_t target{0ull};
+      double weight{0.0};
+      std::uint64_t sum{0ull};
+
+      for (std::size_t i{0ull}; i != size; ++i) {
+        lttoolbox::decode(is, input);
+        lttoolbox::decode(is, output);
+        lttoolbox::decode(is, target);
+        lttoolbox::decode(is, weight);
+        sum += input + output + target + static_cast<std::uint64_t>(weight);
+      }
+
+      return sum;
+    });
+
+    measure("transitions decode_record", size, [&]() -> std::uint64_t {
+      std::istringstream is{encoded_transitions};
+      std::uint32_t input{0u};
+      std::uint32_t output{0u};
+      std::uint64_t target{0ull};
+      double weight{0.0};
+      std::uint64_t sum{0ull};
+
+      for (std::size_t i{0ull}; i != size; ++i) {
+        lttoolbox::decode_record(is, std::tie(input, output, target, weight));
+        sum += input + output + target + static_cast<std::uint64_t>(weight);
+      }
+
+      return sum;
+    });
+  }
+
+  // Alphabet symbols and tags, as decoded when a dictionary is loaded.
+  {
+    std::vector<std::wstring> tags(1ull << 16ull);
+    std::size_t i{0ull};
+
+    for (auto &tag : tags) {
+      tag = L"<tag" + std::to_wstring(i) +
+            (i % 8ull == 0ull ? L"\u00e9>" : L">");
+      ++i;
+    }
+
+    std::string encoded_tags{};
+
+    for (const auto &tag : tags) {
+      std::ostringstream os{};
+      lttoolbox::encode_string(os, tag);
+      encoded_tags += os.str();
+    }
+
+    const char *const tags_last{encoded_tags.data() + encoded_tags.size()};
+
+    measure("strings character by character", tags.size(),
+            [&]() -> std::uint64_t {
+              std::vector<std::wstring> decoded_tags(tags.size());
+              const char *first{encoded_tags.data()};
+              std::uint64_t sum{0ull};
+
+              for (auto &tag : decoded_tags) {
+                std::uint64_t n{0ull};
+                first = lttoolbox::decode(first, tags_last, n);
+
+                for (std::uint64_t c{0ull}; n != 0ull; --n) {
+                  first = lttoolbox::decode(first, tags_last, c);
+                  tag.push_back(static_cast<wchar_t>(c));
+                }
+
+                sum += tag.size();
+              }
+
+              return sum;
+            });
+
+    measure("strings decode_string", tags.size(), [&]() -> std::uint64_t {
+      std::vector<std::wstring> decoded_tags(tags.size());
+      const char *first{encoded_tags.data()};
+      std::uint64_t sum{0ull};
+
+      for (auto &tag : decoded_tags) {
+        first = lttoolbox::decode_string(first, tags_last, tag);
+        sum += tag.size();
+      }
+
+      return sum;
+    });
+
+    measure("strings StringTable", tags.size(), [&]() -> std::uint64_t {
+      lttoolbox::StringTable<wchar_t> table{};
+      table.decode(encoded_tags.data(), tags_last, tags.size());
+      std::uint64_t sum{0ull};
+
+      for (std::size_t k{0ull}; k != table.size(); ++k)
+        sum += table.length(k);
+
+      return sum;
+    });
+  }
+
+  // The same values as group blocks; see group_varint.h.
+  std::vector<char> grouped(lttoolbox::get_group_capacity(size));
+  grouped.resize(lttoolbox::encode_group(grouped.data(), xs.data(), size) -
+                 grouped.data());
+  std::vector<char> grouped_symbols(lttoolbox::get_group_capacity(size));
+  grouped_symbols.resize(lttoolbox::encode_group(grouped_symbols.data(),
+                                                 symbols.data(), size) -
+                         grouped_symbols.data());
+  std::cout << "group blocks: " << grouped.size() << " bytes, symbols "
+            << grouped_symbols.size() << " bytes rather than "
+            << encoded_symbols.size() << '\n';
+
+  // The symbols as bit-packed blocks, and state numbers in the 2nd class
+  // that lie within 4096 of each other, as the targets of the transitions of
+  // one state often do; see bit_packed.h.
+  std::vector<char> packed(lttoolbox::get_bit_packed_capacity(size));
+  packed.resize(lttoolbox::encode_bit_packed(packed.data(), symbols.data(),
+                                             size) -
+                packed.data());
+  std::vector<std::uint64_t> states(size);
+
+  {
+    std::mt19937_64 engine{0x5eedull};
+
+    for (auto &state : states)
+      state = (1ull << 20u) + (engine() & 0xfffull);
+  }
+
+  std::vector<char> encoded_states(9ull * size);
+  encoded_states.resize(lttoolbox::encode_n(encoded_states.data(),
+                                            states.data(), size) -
+                        encoded_states.data());
+  std::vector<char> packed_states(lttoolbox::get_bit_packed_capacity(size));
+  packed_states.resize(lttoolbox::encode_bit_packed(packed_states.data(),
+                                                    states.data(), size) -
+                       packed_states.data());
+  std::cout << "bit-packed blocks: symbols " << packed.size()
+            << " bytes rather than " << encoded_symbols.size() << ", states "
+            << packed_states.size() << " bytes rather than "
+            << encoded_states.size() << '\n';
+  std::vector<std::uint64_t> ys(size);
+
+  for (std::size_t i{0ull}; i != lttoolbox::kernel_count; ++i) {
+    const auto kernel = static_cast<lttoolbox::Kernel>(i);
+
+    if (!lttoolbox::set_kernel(kernel))
+      continue;
+
+    const std::string name{lttoolbox::get_name(kernel)};
+
+    measure("encode_n " + name, size, [&]() -> std::uint64_t {
+      return lttoolbox::encode_n(s.data(), xs.data(), size) - s.data();
+    });
+
+    measure("decode_n " + name, size, [&]() -> std::uint64_t {
+      lttoolbox::decode_n(encoded.data(), encoded.data() + encoded.size(),
+                          decoded.data(), size);
+      std::uint64_t sum{0ull};
+
+      for (const auto &x : decoded)
+        sum += x;
+
+      return sum;
+    });
+
+    measure("encode_n symbols " + name, size, [&]() -> std::uint64_t {
+      return lttoolbox::encode_n(s.data(), symbols.data(), size) - s.data();
+    });
+
+    measure("count_values " + name, size, [&]() -> std::uint64_t {
+      return lttoolbox::count_values(encoded.data(),
+                                     encoded.data() + encoded.size());
+    });
+
+    measure("count_values symbols " + name, size, [&]() -> std::uint64_t {
+      return lttoolbox::count_values(
+          encoded_symbols.data(),
+          encoded_symbols.data() + encoded_symbols.size());
+    });
+
+    measure("decode_n symbols " + name, size, [&]() -> std::uint64_t {
+      lttoolbox::decode_n(encoded_symbols.data(),
+                          encoded_symbols.data() + encoded_symbols.size(),
+                          decoded.data(), size);
+      std::uint64_t sum{0ull};
+
+      for (const auto &x : decoded)
+        sum += x;
+
+      return sum;
+    });
+
+    for (const auto *const group : {&grouped, &grouped_symbols}) {
+      measure(std::string{group == &grouped ? "decode_group " :
+                                               "decode_group symbols "} +
+                  name,
+              size, [&]() -> std::uint64_t {
+                ys.clear();
+                lttoolbox::decode_group(group->data(),
+                                        group->data() + group->size(), ys);
+                std::uint64_t sum{0ull};
+
+                for (const auto &y : ys)
+                  sum += y;
+
+                return sum;
+              });
+    }
+
+    measure("decode_n states " + name, size, [&]() -> std::uint64_t {
+      lttoolbox::decode_n(encoded_states.data(),
+                          encoded_states.data() + encoded_states.size(),
+                          decoded.data(), size);
+      std::uint64_t sum{0ull};
+
+      for (const auto &x : decoded)
+        sum += x;
+
+      return sum;
+    });
+
+    for (const auto *const bits : {&packed, &packed_states}) {
+      measure(std::string{bits == &packed ? "bit_packed symbols " :
+                                             "bit_packed states "} +
+                  name,
+              size, [&]() -> std::uint64_t {
+                ys.clear();
+                lttoolbox::decode_bit_packed(
+                    bits->data(), bits->data() + bits->size(), ys);
+                std::uint64_t sum{0ull};
+
+                for (const auto &y : ys)
+                  sum += y;
+
+                return sum;
+              });
+    }
+  }
+
+  return 0;
+}
+
+// Return `size` values whose widths are 7, 14, 21, 28, and 64 bits with the
+// given relative weights.  The weights {60, 25, 10, 4, 1} approximate compiled
+// transducers: mostly symbols in the 0th and 1st classes, some state numbers
+// in the 2nd and 3rd classes, and a few arbitrary 64-bit values.
+auto generate(const std::size_t size,
+              const std::initializer_list<double> weights)
+    -> std::vector<std::uint64_t> {
+  std::mt19937_64 engine{0x5eedull};
+  std::discrete_distribution<unsigned int> bits{weights};
+  static constexpr unsigned int widths[]{7u, 14u, 21u, 28u, 64u};
+  std::vector<std::uint64_t> xs(size);
+
+  for (auto &x : xs) {
+    const unsigned int width{widths[bits(engine)]};
+    x = width == 64u ? engine() : engine() & ((1ull << width) - 1ull);
+  }
+
+  return xs;
+}
+
+// Print the least time per value, in nanoseconds, over several runs of
+// `function`, which processes `size` values and returns a checksum of them.
+// The checksum is printed too so that the work cannot be optimized away.
+template <class Function>
+void measure(const std::string &name, const std::size_t size,
+             Function function) {
+  double best{0.0};
+  std::uint64_t sum{0ull};
+
+  for (int run{0}; run != 5; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    sum = function();
+    const std::chrono::duration<double, std::nano> elapsed{
+        std::chrono::steady_clock::now() - start};
+
+    if (run == 0 || elapsed.count() < best)
+      best = elapsed.count();
+  }
+
+  std::cout << std::left << std::setw(28) << name << std::right
+            << std::setw(10) << std::fixed << std::setprecision(3)
+            << best / size << " ns/value  (" << std::hex << sum << std::dec
+            << ")\n";
+}
@@ -0,0 +1,231 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "bit_packed.h"
+#include "decode.h"
+#include "encode.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+
+namespace lttoolbox {
+
+namespace {
+
+// The first byte of a block of values in Apertium binary format.
+static constexpr unsigned char varint_mode{0xffu};
+
+// Return the number of significant bits in `x`, which is 0 for 0.
+static inline auto get_width(const std::uint64_t x) -> unsigned int;
+
+static constexpr auto get_width_mask(const unsigned int width)
+    -> std::uint64_t {
+  return width == 64u ? ~0ull : (1ull << width) - 1ull;
+}
+
+// Pack the difference between each of the `n` values starting at `x` and
+// `minimum` into the bytes starting at `s` in `width` bits and then return a
+// pointer to the byte after the last one.
+static auto pack(char *s, const std::uint64_t *x, const std::size_t n,
+                 const std::uint64_t minimum, const unsigned int width)
+    -> decltype(s);
+
+// Unpack 8 values of `width` bits from the `width` bytes starting at `s`, add
+// `minimum` to each of them, and store them in the 8 elements starting at `x`.
+// At least `width` + 8 bytes must be readable at `s`.
+template <unsigned int width>
+static inline void unpack_8(const char *s, std::uint64_t *x,
+                            const std::uint64_t minimum);
+
+// Unpack `n` values of `width` bits starting at `s` into the `n` elements
+// starting at `x` as `unpack_8` does.  The bytes are read 8 values at a time
+// in place until fewer than `width` + 8 remain before `last`, and then from a
+// copy padded with zeros.
+template <unsigned int width>
+static void unpack(const char *s, const char *last, std::uint64_t *x,
+                   const std::size_t n, const std::uint64_t minimum);
+
+using Unpack = void (*)(const char *s, const char *last, std::uint64_t *x,
+                        const std::size_t n, const std::uint64_t minimum);
+
+template <std::size_t... width>
+static constexpr auto get_unpack_table(std::index_sequence<width...>)
+    -> std::array<Unpack, sizeof...(width)> {
+  return {{unpack<width>...}};
+}
+
+// The implementation of `unpack` for each width between 0 and 64.
+static constexpr std::array<Unpack, 65ull> unpack_table{
+    get_unpack_table(std::make_index_sequence<65ull>{})};
+}
+
+auto encode_bit_packed(char *s, const std::uint64_t *x, const std::size_t n)
+    -> decltype(s) {
+  s = encode(s, std::uint64_t{n});
+
+  for (const std::uint64_t *const x_last{x + n}; x != x_last;) {
+    const std::size_t k{std::min<std::size_t>(x_last - x,
+                                              bit_packed_block_size)};
+    const auto minmax = std::minmax_element(x, x + k);
+    const std::uint64_t minimum{*minmax.first};
+    const unsigned int width{get_width(*minmax.second - minimum)};
+    const std::size_t packed_size{encoded_size(minimum) +
+                                  (k * width + 7ull) / 8ull};
+
+    if (packed_size <= encoded_size(x, x + k)) {
+      *s++ = static_cast<char>(width);
+      s = encode(s, minimum);
+      s = pack(s, x, k, minimum, width);
+    } else {
+      *s++ = static_cast<char>(varint_mode);
+      s = encode_n(s, x, k);
+    }
+
+    x += k;
+  }
+
+  return s;
+}
+
+auto decode_bit_packed(const char *first, const char *last,
+                       std::vector<std::uint64_t> &xs) -> decltype(first) {
+  std::uint64_t n{0ull};
+  const char *s{decode(first, last, n)};
+
+  if (s == first)
+    return first;
+
+  // A block of equal values takes only 2 bytes, so the count cannot be
+  // checked against the number of bytes left.  Instead, `xs` grows one
+  // block at a time.
+  const std::size_t size{xs.size()};
+
+  for (std::uint64_t i{0ull}; i != n;) {
+    const std::size_t k{static_cast<std::size_t>(
+        std::min<std::uint64_t>(n - i, bit_packed_block_size))};
+    const std::size_t offset{xs.size()};
+
+    if (s == last) {
+      xs.resize(size);
+      return first;
+    }
+
+    const unsigned char mode = *s++;
+
+    if (mode == varint_mode) {
+      xs.resize(offset + k);
+      const char *const next{decode_n(s, last, xs.data() + offset, k)};
+
+      if (next == s) {
+        xs.resize(size);
+        return first;
+      }
+
+      s = next;
+    } else {
+      std::uint64_t minimum{0ull};
+      const char *const next{decode(s, last, minimum)};
+      const std::size_t packed_size{(k * mode + 7ull) / 8ull};
+
+      if (mode > 64u || next == s ||
+          packed_size > static_cast<std::size_t>(last - next)) {
+        xs.resize(size);
+        return first;
+      }
+
+      xs.resize(offset + k);
+      unpack_table[mode](next, last, xs.data() + offset, k, minimum);
+      s = next + packed_size;
+    }
+
+    i += k;
+  }
+
+  return s;
+}
+
+namespace {
+
+auto get_width(const std::uint64_t x) -> unsigned int {
+  return x == 0ull ? 0u : static_cast<unsigned int>(get_bit_length(x));
+}
+
+auto pack(char *s, const std::uint64_t *x, const std::size_t n,
+          const std::uint64_t minimum, const unsigned int width)
+    -> decltype(s) {
+  const std::size_t size{(n * width + 7ull) / 8ull};
+  std::memset(s, 0, size);
+
+  for (std::size_t i{0ull}; i != n; ++i) {
+    const std::uint64_t y{x[i] - minimum};
+    const std::size_t bit{i * width};
+    const unsigned int shift = bit % 8ull;
+    const std::uint64_t low{y << shift};
+    const std::uint64_t high{shift == 0u ? 0ull : y >> (64u - shift)};
+    char *const t{s + bit / 8ull};
+
+    for (std::size_t j{0ull}; j != (shift + width + 7u) / 8u; ++j)
+      t[j] |= static_cast<char>(j == 8ull ? high : low >> (8ull * j));
+  }
+
+  return s + size;
+}
+
+template <unsigned int width>
+void unpack_8(const char *s, std::uint64_t *x, const std::uint64_t minimum) {
+  // Every shift is a constant, so this is unrolled into 8 loads, shifts, and
+  // masks.  A value wider than 56 bits may end in the 9th byte after the one
+  // that it starts in.  The shift of that byte is split in two so that it is
+  // never by 64 bits, even where it is never executed.
+  for (unsigned int i{0u}; i != 8u; ++i) {
+    const unsigned int bit{i * width};
+    std::uint64_t y{load_little_endian(s + bit / 8u) >> (bit % 8u)};
+
+    if (width + bit % 8u > 64u)
+      y |= static_cast<std::uint64_t>(
+               static_cast<unsigned char>(s[bit / 8u + 8u]))
+           << (63u - bit % 8u) << 1u;
+
+    x[i] = minimum + (y & get_width_mask(width));
+  }
+}
+
+template <unsigned int width>
+void unpack(const char *s, const char *last, std::uint64_t *x,
+            const std::size_t n, const std::uint64_t minimum) {
+  if (width == 0u) {
+    std::fill(x, x + n, minimum);
+    return;
+  }
+
+  std::size_t i{0ull};
+
+  for (; n - i >= 8ull && last - s >= static_cast<std::ptrdiff_t>(width) + 8;
+       i += 8ull, s += width)
+    unpack_8<width>(s, x + i, minimum);
+
+  for (; i < n; i += 8ull, s += width) {
+    char t[72ull]{};
+    std::uint64_t y[8ull];
+    std::copy(s, s + std::min<std::ptrdiff_t>(last - s, width + 8u), t);
+    unpack_8<width>(t, y, minimum);
+    std::copy(y, y + std::min<std::size_t>(n - i, 8ull), x + i);
+  }
+}
+}
+
+} // end namespace lttoolbox
@@ -0,0 +1,64 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_BIT_PACKED_H
+#define APERTIUM_LTTOOLBOX_BIT_PACKED_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+namespace lttoolbox {
+
+// The number of values in each block of a bit-packed sequence but the last.
+static constexpr std::size_t bit_packed_block_size{128ull};
+
+// Encode the `n` values starting at `x` as a bit-packed sequence and then
+// return a pointer to the byte after it.
+//
+// A bit-packed sequence is the number of values, encoded in Apertium binary
+// format, and then a block for each `bit_packed_block_size` values.  Each
+// block is whichever of two modes is smaller:
+//
+//   * a bit width between 0 and 64 in 1 byte, the minimum of the block in
+//     Apertium binary format, and then the difference between each value and
+//     the minimum in that many bits, packed least significant bit first, or
+//   * the byte 0xff and then the values in Apertium binary format.
+//
+// A run of values of similar magnitude, such as the state numbers of a large
+// transducer, is then packed without a first byte per value, and each 8
+// values of a width are decoded from that many bytes by code unrolled for the
+// width.  `s` must point to at least `get_bit_packed_capacity(n)` writable
+// bytes.
+auto encode_bit_packed(char *s, const std::uint64_t *x, const std::size_t n)
+    -> decltype(s);
+
+// Return the greatest number of bytes that `encode_bit_packed` writes.
+constexpr std::size_t get_bit_packed_capacity(const std::size_t n) {
+  return 9ull + (n + bit_packed_block_size - 1ull) / bit_packed_block_size +
+         9ull * n;
+}
+
+// Decode a sequence encoded by `encode_bit_packed` from the bytes in [first,
+// last), append its values to `xs`, and then return a pointer to the byte
+// after it.  If [first, last) does not hold a whole sequence, this function
+// returns `first` and leaves `xs` as it was.
+auto decode_bit_packed(const char *first, const char *last,
+                       std::vector<std::uint64_t> &xs) -> decltype(first);
+
+} // end namespace lttoolbox
+
+#endif
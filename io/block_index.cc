@@ -0,0 +1,152 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "block_index.h"
+#include "decode.h"
+#include "delta.h"
+#include "encode.h"
+
+#include <limits>
+#include <utility>
+
+namespace lttoolbox {
+
+namespace {
+
+// Skip the value at `s` without decoding it and then return a pointer to the
+// byte after it, or, if it is truncated, return a null pointer.
+static inline auto skip(const char *s, const char *last) -> const char *;
+}
+
+BlockIndex::BlockIndex()
+    : block_size_{default_block_size}, size_{0ull}, offsets{} {}
+
+BlockIndex::BlockIndex(const char *first, const char *last,
+                       const std::size_t block_size)
+    : block_size_{block_size == 0ull ? 1ull : block_size}, size_{0ull},
+      offsets{} {
+  for (const char *s{first}; s != last; ++size_) {
+    const char *const next{skip(s, last)};
+
+    if (next == nullptr)
+      break;
+
+    if (size_ % block_size_ == 0ull)
+      offsets.push_back(s - first);
+
+    s = next;
+  }
+}
+
+auto BlockIndex::block_size() const -> std::size_t { return block_size_; }
+
+auto BlockIndex::size() const -> std::size_t { return size_; }
+
+auto BlockIndex::block_count() const -> std::size_t { return offsets.size(); }
+
+auto BlockIndex::offset(const std::size_t block) const -> std::size_t {
+  return block < offsets.size() ? offsets[block]
+                                : std::numeric_limits<std::size_t>::max();
+}
+
+auto encode_index(std::ostream &os, const BlockIndex &index)
+    -> std::ostream & {
+  std::vector<char> s(9ull * (index.offsets.size() + 3ull));
+  char *last{encode(s.data(), std::uint64_t{index.block_size_})};
+  last = encode(last, std::uint64_t{index.size_});
+  last = encode_delta(last, index.offsets.data(), index.offsets.size());
+  return os.write(s.data(), last - s.data());
+}
+
+auto decode_index(const char *first, const char *last, BlockIndex &index)
+    -> const char * {
+  std::uint64_t block_size{0ull};
+  std::uint64_t size{0ull};
+  std::vector<std::uint64_t> offsets{};
+  const char *s{decode(first, last, block_size)};
+
+  if (s == first || block_size == 0ull)
+    return first;
+
+  const char *next{decode(s, last, size)};
+
+  if (next == s)
+    return first;
+
+  s = next;
+  next = decode_delta(s, last, offsets);
+
+  // There must be an offset for the start of each block.  Rounding the
+  // quotient up by adding `block_size` - 1 first could overflow.
+  if (next == s ||
+      offsets.size() != size / block_size + (size % block_size != 0ull) ||
+      (!offsets.empty() && offsets.front() != 0ull))
+    return first;
+
+  for (std::size_t i{1ull}; i < offsets.size(); ++i)
+    if (offsets[i] < offsets[i - 1ull] ||
+        offsets[i] - offsets[i - 1ull] < block_size)
+      return first;
+
+  index.block_size_ = block_size;
+  index.size_ = size;
+  index.offsets = std::move(offsets);
+  return next;
+}
+
+auto seek_to_value(const char *first, const char *last,
+                   const BlockIndex &index, const std::size_t k)
+    -> const char * {
+  if (k > index.size())
+    return nullptr;
+
+  if (index.size() == 0ull)
+    return first;
+
+  // If k is the number of values and that is a multiple of the block size,
+  // there is no block that the kth value is in, so skip the whole last block.
+  std::size_t block{k / index.block_size()};
+
+  if (block * index.block_size() == index.size())
+    --block;
+
+  if (index.offset(block) > static_cast<std::size_t>(last - first))
+    return nullptr;
+
+  const char *s{first + index.offset(block)};
+
+  for (std::size_t i{block * index.block_size()}; i != k; ++i)
+    if ((s = skip(s, last)) == nullptr)
+      return nullptr;
+
+  return s;
+}
+
+namespace {
+
+auto skip(const char *s, const char *last) -> const char * {
+  if (s == last)
+    return nullptr;
+
+  const std::size_t n{class_table.n[static_cast<unsigned char>(*s)]};
+
+  if (static_cast<std::size_t>(last - s) <= n)
+    return nullptr;
+
+  return s + 1ull + n;
+}
+}
+
+} // end namespace lttoolbox
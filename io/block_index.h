@@ -0,0 +1,100 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_BLOCK_INDEX_H
+#define APERTIUM_LTTOOLBOX_BLOCK_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <ostream>
+#include <vector>
+
+namespace lttoolbox {
+
+// The byte offset of every `block_size`th value in a buffer of values encoded
+// in Apertium binary format, so that the kth value can be found by skipping at
+// most `block_size` - 1 values instead of k.
+//
+// An index can be kept in a separate file or appended to the values it
+// indexes; see `encode_index` and `decode_index`.
+class BlockIndex {
+public:
+  static constexpr std::size_t default_block_size{64ull};
+
+  BlockIndex();
+
+  // Index the whole values in [first, last).  Skipping a value needs only its
+  // first byte, so no value is decoded.  Indexing stops at the first value
+  // that is truncated.
+  BlockIndex(const char *first, const char *last,
+             const std::size_t block_size = default_block_size);
+
+  // The number of values per block.
+  auto block_size() const -> std::size_t;
+
+  // The number of values indexed.
+  auto size() const -> std::size_t;
+
+  // The number of blocks, the last of which may hold fewer than
+  // `block_size()` values.
+  auto block_count() const -> std::size_t;
+
+  // The byte offset of the first value of the `block`th block, or, if there is
+  // no such block, the greatest `std::size_t`, which is past the end of any
+  // buffer.
+  auto offset(const std::size_t block) const -> std::size_t;
+
+private:
+  friend auto encode_index(std::ostream &os, const BlockIndex &index)
+      -> std::ostream &;
+  friend auto decode_index(const char *first, const char *last,
+                           BlockIndex &index) -> const char *;
+
+  std::size_t block_size_;
+  std::size_t size_;
+  std::vector<std::uint64_t> offsets;
+};
+
+// Encode `index` in Apertium binary format: the block size, the number of
+// values, and then the offsets as a sequence encoded by `encode_delta`.
+auto encode_index(std::ostream &os, const BlockIndex &index) -> std::ostream &;
+
+// Decode an index encoded by `encode_index` from the bytes in [first, last)
+// into `index` and then return a pointer to the byte after it.  If [first,
+// last) does not hold a whole index, this function returns `first` and leaves
+// `index` unchanged.
+//
+// The index may come from an untrusted file, so it is also rejected unless the
+// block size is not 0, there is exactly one offset per block, the first offset
+// is 0, and each offset is at least the block size after the one before it,
+// since each value takes at least 1 byte.  Whether the offsets lie within the
+// values is checked when they are used, since the values may be elsewhere.
+auto decode_index(const char *first, const char *last, BlockIndex &index)
+    -> const char *;
+
+// Return a pointer to the kth value in [first, last), which `index` indexes,
+// or, if k is `index.size()`, to the byte after the last value indexed.
+//
+// This function skips at most `index.block_size()` - 1 values after the start
+// of the block that the kth value is in.  If k is greater than `index.size()`,
+// it returns a null pointer.
+auto seek_to_value(const char *first, const char *last,
+                   const BlockIndex &index, const std::size_t k)
+    -> const char *;
+
+} // end namespace lttoolbox
+
+#endif
@@ -14,72 +14,878 @@
 // along with io.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "decode.h"
+#include "kernel.h"
+#include "streambuf.h"
+
+#include <algorithm>
+#include <limits>
 
 namespace lttoolbox {
 
+namespace {
+
+// Decode a value into `x` directly from the get area of the buffer of `is` and
+// then return true, or, if the get area does not hold a whole value that fits
+// in `T`, return false without extracting anything.
+//
+// This skips the sentry and the virtual calls of `std::istream::get` and
+// `std::istream::read`.  A tied stream must be flushed first, as the sentry
+// would, so false is returned for a stream with one.  `gcount` is not set.
+template <class T>
+static inline auto decode_buffered(std::istream &is, T &x) -> bool;
+
+// Decode a value from `first`, which must be followed by at least 8 bytes,
+// into `x` and then return a pointer to the byte after the value.
+static inline auto decode_unchecked(const char *first, std::uint64_t &x)
+    -> decltype(first);
+
+template <class T>
+static inline auto decode_n_(const char *first, const char *last, T *x,
+                             const std::size_t n) -> decltype(first);
+
+// Decode `n` values into the unsigned type `U` as `decode_n` does and then map
+// them to the signed type `T` as `from_zigzag` does.
+template <class U, class T>
+static inline auto decode_n_zigzag_(const char *first, const char *last, T *x,
+                                    const std::size_t n) -> decltype(first);
+
+// Decode `n` values with `decode` and append them to `xs`, or, if that
+// returns `first`, leave `xs` as it was.
+template <class T>
+static inline auto decode_n_(const char *first, const char *last,
+                             std::vector<T> &xs, const std::size_t n,
+                             auto (*decode)(const char *, const char *, T *,
+                                            std::size_t) -> const char *)
+    -> decltype(first);
+
+static auto decode_n_scalar(const char *first, const char *last,
+                            std::uint64_t *x, const std::size_t n)
+    -> decltype(first);
+
+#if HAVE_X86_SIMD
+
+// Decode values from `s` into `x` for as long as at least 32 bytes remain in
+// [s, last) and at least 16 elements remain in [x, x_last), advancing both
+// `s` and `x` past what was decoded.
+__attribute__((target("ssse3,sse4.1"))) static void
+decode_vector_sse41(const char *&s, const char *last, std::uint64_t *&x,
+                    std::uint64_t *x_last);
+__attribute__((target("avx2"))) static void
+decode_vector_avx2(const char *&s, const char *last, std::uint64_t *&x,
+                   std::uint64_t *x_last);
+
+// Decode with `decode_vector` and then decode whatever remains with
+// `decode_n_`.
+template <void (&decode_vector)(const char *&, const char *, std::uint64_t *&,
+                                std::uint64_t *)>
+static auto decode_n_vector(const char *first, const char *last,
+                            std::uint64_t *x, const std::size_t n)
+    -> decltype(first);
+
+__attribute__((target("bmi,bmi2,lzcnt"))) static auto
+decode_n_bmi2(const char *first, const char *last, std::uint64_t *x,
+              const std::size_t n) -> decltype(first);
+
+#endif
+
+// Count the whole values in [first, last) into `n` and then return a pointer
+// to the byte after the last of them.
+static auto count_values_scalar(const char *first, const char *last,
+                                std::size_t &n) -> decltype(first);
+
+#if HAVE_X86_SIMD
+
+// Count as `count_values_scalar` does, but skip runs of 16 or 32 values in the
+// 0th class, respectively, at once, and otherwise classify all 16 or 32 bytes
+// at once and count the values that start in them without a step each.
+__attribute__((target("ssse3,sse4.1"))) static auto
+count_values_sse41(const char *first, const char *last, std::size_t &n)
+    -> decltype(first);
+__attribute__((target("avx2"))) static auto
+count_values_avx2(const char *first, const char *last, std::size_t &n)
+    -> decltype(first);
+
+#endif
+
+// The implementation of `decode_n` for each `Kernel`.
+static auto (*const decode_n_kernels[kernel_count])(
+    const char *first, const char *last, std::uint64_t *x,
+    const std::size_t n) -> decltype(first){
+    decode_n_scalar,
+
+#if HAVE_X86_SIMD
+
+    decode_n_vector<decode_vector_sse41>,
+    decode_n_vector<decode_vector_avx2>,
+    decode_n_bmi2
+
+#else
+
+    decode_n_scalar, decode_n_scalar, decode_n_scalar
+
+#endif
+};
+
+// The implementation of `count_values` and `validate` for each `Kernel`.
+static auto (*const count_values_kernels[kernel_count])(const char *first,
+                                                        const char *last,
+                                                        std::size_t &n)
+    -> decltype(first){
+    count_values_scalar,
+
+#if HAVE_X86_SIMD
+
+    count_values_sse41, count_values_avx2, count_values_scalar
+
+#else
+
+    count_values_scalar, count_values_scalar, count_values_scalar
+
+#endif
+};
+}
+
 auto decode(std::istream &is, std::uint64_t &x) -> decltype(is) {
-  char c{0};
-  is.get(c);
-  return Decoder<0ull>::decode(is, x, c);
+  if (decode_buffered(is, x))
+    return is;
+
+  char s[9ull];
+
+  if (!is.get(*s))
+    return is;
+
+  const std::size_t n{class_table.n[static_cast<unsigned char>(*s)]};
+
+  if (n != 0ull && !is.read(s + 1ull, n))
+    return is;
+
+  decode(s, s + 1ull + n, x);
+  return is;
+}
+
+auto decode(const char *first, const char *last, std::uint64_t &x)
+    -> decltype(first) {
+  if (first == last)
+    return first;
+
+#if ENABLE_BRANCHLESS_DECODE
+
+  // Whenever the buffer holds the 8 bytes after the first byte, load them all
+  // at once whatever the class is.
+  if (last - first > 8)
+    return decode_unchecked(first, x);
+
+  const unsigned char c = *first;
+  const std::size_t n{class_table.n[c]};
+
+  if (static_cast<std::size_t>(last - first) < 1ull + n)
+    return first;
+
+  char s[8ull]{};
+  std::copy(first + 1ull, first + 1ull + n, s);
+  x = get_x(c, n, load_big_endian(s));
+  return first + 1ull + n;
+
+#else
+
+  return Decoder<0ull>::decode(first, last, x, *first);
+
+#endif
+}
+
+auto decode_count(const char *first, const char *last, std::uint64_t &n)
+    -> decltype(first) {
+  std::uint64_t m{0ull};
+  const char *const s{decode(first, last, m)};
+
+  if (s == first || m > static_cast<std::uint64_t>(last - s))
+    return first;
+
+  n = m;
+  return s;
+}
+
+auto decode(std::istream &is, double &x) -> decltype(is) {
+  std::uint64_t y{0ull};
+
+  if (decode(is, y))
+    x = from_float_bits(y);
+
+  return is;
+}
+
+auto decode(const char *first, const char *last, double &x)
+    -> decltype(first) {
+  std::uint64_t y{0ull};
+  const char *const s{decode(first, last, y)};
+
+  if (s != first)
+    x = from_float_bits(y);
+
+  return s;
+}
+
+auto decode(std::istream &is, float &x) -> decltype(is) {
+  std::uint32_t y{0u};
+
+  if (decode(is, y))
+    x = from_float_bits(y);
+
+  return is;
+}
+
+auto decode(const char *first, const char *last, float &x) -> decltype(first) {
+  std::uint32_t y{0u};
+  const char *const s{decode(first, last, y)};
+
+  if (s != first)
+    x = from_float_bits(y);
+
+  return s;
+}
+
+template <class T>
+auto decode(std::istream &is, T &x) ->
+    typename std::enable_if<is_narrow<T>::value, std::istream &>::type {
+  if (decode_buffered(is, x))
+    return is;
+
+  char s[9ull];
+
+  if (!is.get(*s))
+    return is;
+
+  const std::size_t n{class_table.n[static_cast<unsigned char>(*s)]};
+
+  if (n > get_maximum_class(8ull * sizeof(T))) {
+    is.setstate(is.failbit);
+    return is;
+  }
+
+  if (n != 0ull && !is.read(s + 1ull, n))
+    return is;
+
+  if (decode(s, s + 1ull + n, x) == s)
+    is.setstate(is.failbit);
+
+  return is;
+}
+
+template <class T>
+auto decode(const char *first, const char *last, T &x) ->
+    typename std::enable_if<is_narrow<T>::value, const char *>::type {
+  static constexpr std::size_t m{get_maximum_class(8ull * sizeof(T))};
+
+  if (first == last)
+    return first;
+
+  std::uint64_t y{0ull};
+
+#if ENABLE_BRANCHLESS_DECODE
+
+  if (class_table.n[static_cast<unsigned char>(*first)] > m)
+    return first;
+
+  const char *const s{decode(first, last, y)};
+
+#else
+
+  const char *const s{
+      Decoder<0ull>::template decode<m>(first, last, y, *first)};
+
+#endif
+
+  if (s == first || y > std::numeric_limits<T>::max())
+    return first;
+
+  x = static_cast<T>(y);
+  return s;
+}
+
+template auto decode(std::istream &is, std::uint8_t &x) -> std::istream &;
+template auto decode(std::istream &is, std::uint16_t &x) -> std::istream &;
+template auto decode(std::istream &is, std::uint32_t &x) -> std::istream &;
+template auto decode(const char *first, const char *last, std::uint8_t &x)
+    -> const char *;
+template auto decode(const char *first, const char *last, std::uint16_t &x)
+    -> const char *;
+template auto decode(const char *first, const char *last, std::uint32_t &x)
+    -> const char *;
+
+auto decode_n(const char *first, const char *last, std::uint64_t *x,
+              const std::size_t n) -> decltype(first) {
+  return decode_n_kernels[static_cast<std::size_t>(
+      get_kernel(Operation::decode))](first, last, x, n);
+}
+
+auto decode_n(const char *first, const char *last, std::uint32_t *x,
+              const std::size_t n) -> decltype(first) {
+  return decode_n_(first, last, x, n);
+}
+
+auto decode_n(const char *first, const char *last,
+              std::vector<std::uint64_t> &xs, const std::size_t n)
+    -> decltype(first) {
+  return decode_n_(first, last, xs, n, decode_n);
+}
+
+auto decode_n(const char *first, const char *last,
+              std::vector<std::uint32_t> &xs, const std::size_t n)
+    -> decltype(first) {
+  return decode_n_(first, last, xs, n, decode_n);
+}
+
+auto decode_n_zigzag(const char *first, const char *last, std::int64_t *x,
+                     const std::size_t n) -> decltype(first) {
+  return decode_n_zigzag_<std::uint64_t>(first, last, x, n);
+}
+
+auto decode_n_zigzag(const char *first, const char *last, std::int32_t *x,
+                     const std::size_t n) -> decltype(first) {
+  return decode_n_zigzag_<std::uint32_t>(first, last, x, n);
+}
+
+auto decode_n_zigzag(const char *first, const char *last,
+                     std::vector<std::int64_t> &xs, const std::size_t n)
+    -> decltype(first) {
+  return decode_n_(first, last, xs, n, decode_n_zigzag);
+}
+
+auto decode_n_zigzag(const char *first, const char *last,
+                     std::vector<std::int32_t> &xs, const std::size_t n)
+    -> decltype(first) {
+  return decode_n_(first, last, xs, n, decode_n_zigzag);
+}
+
+auto count_values(const char *first, const char *last) -> std::size_t {
+  std::size_t n{0ull};
+  count_values_kernels[static_cast<std::size_t>(
+      get_kernel(Operation::decode))](first, last, n);
+  return n;
 }
 
+auto validate(const char *first, const char *last) -> decltype(first) {
+  std::size_t n{0ull};
+  return count_values_kernels[static_cast<std::size_t>(
+      get_kernel(Operation::decode))](first, last, n);
+}
+
+auto validate(const char *first, const char *last, std::size_t &n)
+    -> decltype(first) {
+  return count_values_kernels[static_cast<std::size_t>(
+      get_kernel(Operation::decode))](first, last, n);
+}
+
+namespace {
+
+template <class T> auto decode_buffered(std::istream &is, T &x) -> bool {
+  const char *last{nullptr};
+  const char *const first{StreambufAccess::get_get_area(is, last)};
+
+  if (first == last)
+    return false;
+
+  const char *const s{decode(first, last, x)};
+
+  if (s == first)
+    return false;
+
+  StreambufAccess::bump_get(*is.rdbuf(), s - first);
+  return true;
+}
+
+auto decode_unchecked(const char *first, std::uint64_t &x) -> decltype(first) {
+#if ENABLE_BRANCHLESS_DECODE
+
+  // Look up the class instead of comparing the first byte against each
+  // `Decoder<n>::maximum_c` in turn.
+  const unsigned char c = *first;
+  const std::size_t n{class_table.n[c]};
+  x = get_x(c, n, load_big_endian(first + 1ull));
+  return first + 1ull + n;
+
+#else
+
+  // Since `last` is a constant distance from `first`, each of the checks for
+  // truncation is always false, so the compiler can remove all of them.
+  return Decoder<0ull>::decode(first, first + 9ull, x, *first);
+
+#endif
+}
+
+template <class T>
+auto decode_n_(const char *first, const char *last, T *x, const std::size_t n)
+    -> decltype(first) {
+  const char *s{first};
+  T *const x_last{x + n};
+  std::uint64_t y{0ull};
+
+  // While at least 9 bytes remain, no value can be truncated.
+  for (; x != x_last && last - s > 8; ++x) {
+    s = decode_unchecked(s, y);
+
+    if (y > std::numeric_limits<T>::max())
+      return first;
+
+    *x = y;
+  }
+
+  for (; x != x_last; ++x) {
+    const char *const next{decode(s, last, y)};
+
+    if (next == s || y > std::numeric_limits<T>::max())
+      return first;
+
+    s = next;
+    *x = y;
+  }
+
+  return s;
+}
+
+auto decode_n_scalar(const char *first, const char *last, std::uint64_t *x,
+                     const std::size_t n) -> decltype(first) {
+  return decode_n_(first, last, x, n);
+}
+
+auto count_values_scalar(const char *first, const char *last, std::size_t &n)
+    -> decltype(first) {
+  for (; first != last; ++n) {
+    const std::size_t m{class_table.n[static_cast<unsigned char>(*first)]};
+
+    if (static_cast<std::size_t>(last - first) <= m)
+      break;
+
+    first += 1ull + m;
+  }
+
+  return first;
+}
+
+template <class U, class T>
+auto decode_n_zigzag_(const char *first, const char *last, T *x,
+                      const std::size_t n) -> decltype(first) {
+  // A signed type and its unsigned counterpart may alias each other, so decode
+  // the unsigned values in place and then map each in turn.
+  auto *const y = reinterpret_cast<U *>(x);
+  const char *const s{decode_n(first, last, y, n)};
+
+  if (s != first)
+    for (std::size_t i{0ull}; i != n; ++i)
+      x[i] = from_zigzag<T>(y[i]);
+
+  return s;
+}
+
+template <class T>
+auto decode_n_(const char *first, const char *last, std::vector<T> &xs,
+               const std::size_t n,
+               auto (*decode)(const char *, const char *, T *, std::size_t)
+                   -> const char *) -> decltype(first) {
+  const std::size_t size{xs.size()};
+  xs.resize(size + n);
+  const char *const s{decode(first, last, xs.data() + size, n)};
+
+  if (s == first && n != 0ull)
+    xs.resize(size);
+
+  return s;
+}
+}
+
+#if HAVE_X86_SIMD
+
+namespace {
+
+// For each combination of which of 8 bytes have their most significant bit
+// set, assuming that every value starting in those bytes is in the 0th or 1st
+// class, the shuffle that moves each value into its own little-endian 16-bit
+// lane, the number of values, the number of bytes that they take, and which
+// of the bytes are first bytes.
+//
+// A first byte in the 1st class is moved with its leading one still set, so
+// the lanes must be masked with 0x3fff afterward.  The last value may end in
+// the 9th byte.
+class ShuffleTable {
+public:
+  constexpr ShuffleTable() : shuffle{}, count{}, size{}, first_c{} {
+    for (std::size_t h{0ull}; h != 256ull; ++h) {
+      std::size_t i{0ull};
+      std::size_t k{0ull};
+
+      for (; i < 8ull; ++k) {
+        first_c[h] |= 1u << i;
+
+        if ((h >> i & 1ull) == 0ull) {
+          shuffle[h][2ull * k] = i;
+          shuffle[h][2ull * k + 1ull] = 0x80u;
+          i += 1ull;
+        } else {
+          shuffle[h][2ull * k] = i + 1ull;
+          shuffle[h][2ull * k + 1ull] = i;
+          i += 2ull;
+        }
+      }
+
+      count[h] = k;
+      size[h] = i;
+
+      for (; k != 8ull; ++k) {
+        shuffle[h][2ull * k] = 0x80u;
+        shuffle[h][2ull * k + 1ull] = 0x80u;
+      }
+    }
+  }
+
+  unsigned char shuffle[256ull][16ull];
+  unsigned char count[256ull];
+  unsigned char size[256ull];
+  unsigned char first_c[256ull];
+};
+
+static constexpr ShuffleTable shuffle_table{};
+
+// Decode the values that start in the first 8 bytes at `s`.  If any of them
+// is not in the 0th or 1st class, decode only the values before it, and then
+// decode it and every value in the 2nd class or greater that follows it with
+// `decode_unchecked`, so that a run of long values does not cost a shuffle
+// that is thrown away for each of them.  At least 32 bytes must remain after
+// `s` and at least 16 elements after `x` before `x_last`.
+__attribute__((target("ssse3,sse4.1"))) static inline void
+decode_8_sse41(const char *&s, const char *last, std::uint64_t *&x,
+               const std::uint64_t *x_last) {
+  const __m128i v{_mm_loadu_si128(reinterpret_cast<const __m128i *>(s))};
+  const unsigned int h = _mm_movemask_epi8(v) & 0xffu;
+
+  // A first byte with both of its two most significant bits set is in the
+  // 2nd class or greater.  Adding a byte to itself moves its second most
+  // significant bit into its most significant bit.
+  const unsigned int h2 = _mm_movemask_epi8(_mm_add_epi8(v, v)) & h &
+                          shuffle_table.first_c[h];
+  const unsigned int i = h2 == 0u ? 8u : __builtin_ctz(h2);
+
+  if (i != 0u) {
+    const __m128i y{_mm_and_si128(
+        _mm_shuffle_epi8(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+                                shuffle_table.shuffle[h]))),
+        _mm_set1_epi16(0x3fff))};
+    auto *const z = reinterpret_cast<__m128i *>(x);
+    _mm_storeu_si128(z, _mm_cvtepu16_epi64(y));
+    _mm_storeu_si128(z + 1, _mm_cvtepu16_epi64(_mm_srli_si128(y, 4)));
+    _mm_storeu_si128(z + 2, _mm_cvtepu16_epi64(_mm_srli_si128(y, 8)));
+    _mm_storeu_si128(z + 3, _mm_cvtepu16_epi64(_mm_srli_si128(y, 12)));
+
+    if (h2 == 0u) {
+      s += shuffle_table.size[h];
+      x += shuffle_table.count[h];
+      return;
+    }
+
+    // Keep only the values before the first one in a greater class.
+    x += __builtin_popcount(shuffle_table.first_c[h] & ((1u << i) - 1u));
+    s += i;
+  }
+
+  do
+    s = decode_unchecked(s, *x++);
+  while (x != x_last && last - s > 8 &&
+         static_cast<unsigned char>(*s) >= 0xc0u);
+}
+
+__attribute__((target("ssse3,sse4.1"))) void
+decode_vector_sse41(const char *&s, const char *last, std::uint64_t *&x,
+                    std::uint64_t *x_last) {
+  while (last - s >= 32 && x_last - x >= 16) {
+    const __m128i v{_mm_loadu_si128(reinterpret_cast<const __m128i *>(s))};
+
+    // 16 values in the 0th class are simply zero-extended.
+    if (_mm_movemask_epi8(v) == 0) {
+      auto *const z = reinterpret_cast<__m128i *>(x);
+
+      _mm_storeu_si128(z, _mm_cvtepu8_epi64(v));
+      _mm_storeu_si128(z + 1, _mm_cvtepu8_epi64(_mm_srli_si128(v, 2)));
+      _mm_storeu_si128(z + 2, _mm_cvtepu8_epi64(_mm_srli_si128(v, 4)));
+      _mm_storeu_si128(z + 3, _mm_cvtepu8_epi64(_mm_srli_si128(v, 6)));
+      _mm_storeu_si128(z + 4, _mm_cvtepu8_epi64(_mm_srli_si128(v, 8)));
+      _mm_storeu_si128(z + 5, _mm_cvtepu8_epi64(_mm_srli_si128(v, 10)));
+      _mm_storeu_si128(z + 6, _mm_cvtepu8_epi64(_mm_srli_si128(v, 12)));
+      _mm_storeu_si128(z + 7, _mm_cvtepu8_epi64(_mm_srli_si128(v, 14)));
+
+      s += 16;
+      x += 16;
+      continue;
+    }
+
+    decode_8_sse41(s, last, x, x_last);
+  }
+}
+
+__attribute__((target("avx2"))) void
+decode_vector_avx2(const char *&s, const char *last, std::uint64_t *&x,
+                   std::uint64_t *x_last) {
+  while (last - s >= 32 && x_last - x >= 16) {
+    const __m256i v{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(s))};
+
+    // 32 values in the 0th class are simply zero-extended.
+    if (_mm256_movemask_epi8(v) == 0 && x_last - x >= 32) {
+      auto *const z = reinterpret_cast<__m256i *>(x);
+      const __m128i lo{_mm256_castsi256_si128(v)};
+      const __m128i hi{_mm256_extracti128_si256(v, 1)};
+
+      _mm256_storeu_si256(z, _mm256_cvtepu8_epi64(lo));
+      _mm256_storeu_si256(z + 1, _mm256_cvtepu8_epi64(_mm_srli_si128(lo, 4)));
+      _mm256_storeu_si256(z + 2, _mm256_cvtepu8_epi64(_mm_srli_si128(lo, 8)));
+      _mm256_storeu_si256(z + 3,
+                          _mm256_cvtepu8_epi64(_mm_srli_si128(lo, 12)));
+      _mm256_storeu_si256(z + 4, _mm256_cvtepu8_epi64(hi));
+      _mm256_storeu_si256(z + 5, _mm256_cvtepu8_epi64(_mm_srli_si128(hi, 4)));
+      _mm256_storeu_si256(z + 6, _mm256_cvtepu8_epi64(_mm_srli_si128(hi, 8)));
+      _mm256_storeu_si256(z + 7,
+                          _mm256_cvtepu8_epi64(_mm_srli_si128(hi, 12)));
+
+      s += 32;
+      x += 32;
+      continue;
+    }
+
+    decode_8_sse41(s, last, x, x_last);
+  }
+}
+
+template <void (&decode_vector)(const char *&, const char *, std::uint64_t *&,
+                                std::uint64_t *)>
+auto decode_n_vector(const char *first, const char *last, std::uint64_t *x,
+                     const std::size_t n) -> decltype(first) {
+  const char *s{first};
+  std::uint64_t *y{x};
+  decode_vector(s, last, y, x + n);
+  const std::size_t m = x + n - y;
+  const char *const t{decode_n_(s, last, y, m)};
+  return t == s && m != 0ull ? first : t;
+}
+
+__attribute__((target("bmi,bmi2,lzcnt"))) auto
+decode_n_bmi2(const char *first, const char *last, std::uint64_t *x,
+              const std::size_t n) -> decltype(first) {
+  const char *s{first};
+  std::uint64_t *const x_last{x + n};
+
+  for (; x != x_last && last - s > 8; ++x) {
+    // The class is the number of leading zeros of the inverted first byte.
+    // Setting the bit after it keeps the count at most 8.
+    const unsigned char c = *s;
+    const std::size_t m =
+        _lzcnt_u32(~static_cast<unsigned int>(c) << 24u | 0x80'00'00u);
+    *x = get_x(c, m, load_big_endian(s + 1ull));
+    s += 1ull + m;
+  }
+
+  const std::size_t m = x_last - x;
+  const char *const t{decode_n_(s, last, x, m)};
+  return t == s && m != 0ull ? first : t;
+}
+
+// The number of leading ones in each nibble.
+#define NIBBLE_CLASSES 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 3, 4
+
+// Count the values that start in the 16 bytes `v` at `s` into `n` and then
+// return the offset from `s` of the first value after them.  At least 24
+// bytes must remain after `s`.
+//
+// Each byte is classified as if a value started in it, giving the offset of
+// the value that would follow, and then the offsets are followed from every
+// byte at once by doubling: after the kth round, each byte holds where the
+// values that start from it leave the 16 bytes, or where the 2^kth one does,
+// and how many values that is.  Only the values from the 0th byte are used.
+__attribute__((target("ssse3,sse4.1"))) static inline auto
+count_16_sse41(const __m128i v, std::size_t &n) -> unsigned int {
+  const __m128i classes{_mm_setr_epi8(NIBBLE_CLASSES)};
+  const __m128i low{_mm_set1_epi8(0x0f)};
+  const __m128i c{
+      _mm_shuffle_epi8(classes, _mm_and_si128(_mm_srli_epi16(v, 4), low))};
+  const __m128i c_low{_mm_shuffle_epi8(classes, _mm_and_si128(v, low))};
+
+  // The class is that of the more significant nibble or, if it is all ones,
+  // that and the class of the less significant one.
+  __m128i next{_mm_add_epi8(
+      _mm_add_epi8(c, _mm_setr_epi8(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
+                                    14, 15, 16)),
+      _mm_and_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8(4)), c_low))};
+  __m128i count{_mm_set1_epi8(1)};
+
+  for (int k{0}; k != 4; ++k) {
+    // Offsets past the 16 bytes are at most 24, so shuffling by them selects
+    // a byte that is discarded.
+    const __m128i inside{_mm_cmpgt_epi8(_mm_set1_epi8(16), next)};
+    count = _mm_add_epi8(
+        count, _mm_and_si128(inside, _mm_shuffle_epi8(count, next)));
+    next = _mm_blendv_epi8(next, _mm_shuffle_epi8(next, next), inside);
+  }
+
+  n += static_cast<unsigned int>(_mm_cvtsi128_si32(count)) & 0xffu;
+  return static_cast<unsigned int>(_mm_cvtsi128_si32(next)) & 0xffu;
+}
+
+// Count as `count_16_sse41` does, but classify and follow the offsets in both
+// 16-byte halves of `v` at once, and then continue from where the values in
+// the less significant half leave it.  At least 40 bytes must remain after
+// `s`.
+__attribute__((target("avx2"))) static inline auto
+count_32_avx2(const __m256i v, std::size_t &n) -> unsigned int {
+  const __m256i classes{_mm256_setr_epi8(NIBBLE_CLASSES, NIBBLE_CLASSES)};
+  const __m256i low{_mm256_set1_epi8(0x0f)};
+  const __m256i c{_mm256_shuffle_epi8(
+      classes, _mm256_and_si256(_mm256_srli_epi16(v, 4), low))};
+  const __m256i c_low{_mm256_shuffle_epi8(classes, _mm256_and_si256(v, low))};
+  __m256i next{_mm256_add_epi8(
+      _mm256_add_epi8(c, _mm256_setr_epi8(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+                                          12, 13, 14, 15, 16, 1, 2, 3, 4, 5,
+                                          6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                          16)),
+      _mm256_and_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(4)), c_low))};
+  __m256i count{_mm256_set1_epi8(1)};
+
+  for (int k{0}; k != 4; ++k) {
+    const __m256i inside{_mm256_cmpgt_epi8(_mm256_set1_epi8(16), next)};
+    count = _mm256_add_epi8(
+        count, _mm256_and_si256(inside, _mm256_shuffle_epi8(count, next)));
+    next = _mm256_blendv_epi8(next, _mm256_shuffle_epi8(next, next), inside);
+  }
+
+  // The values from the 0th byte leave the less significant half at most 8
+  // bytes into the more significant one.
+  const unsigned int i =
+      static_cast<unsigned int>(_mm256_cvtsi256_si32(next)) & 0xffu;
+  const __m128i j{_mm_set1_epi8(static_cast<char>(i - 16u))};
+  n += (static_cast<unsigned int>(_mm256_cvtsi256_si32(count)) & 0xffu) +
+       (static_cast<unsigned int>(_mm_cvtsi128_si32(_mm_shuffle_epi8(
+            _mm256_extracti128_si256(count, 1), j))) &
+        0xffu);
+  return 16u + (static_cast<unsigned int>(_mm_cvtsi128_si32(_mm_shuffle_epi8(
+                    _mm256_extracti128_si256(next, 1), j))) &
+                0xffu);
+}
+
+#undef NIBBLE_CLASSES
+
+__attribute__((target("ssse3,sse4.1"))) auto
+count_values_sse41(const char *first, const char *last, std::size_t &n)
+    -> decltype(first) {
+  while (last - first >= 24) {
+    const __m128i v{
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(first))};
+
+    if (_mm_movemask_epi8(v) == 0) {
+      first += 16;
+      n += 16ull;
+      continue;
+    }
+
+    first += count_16_sse41(v, n);
+  }
+
+  return count_values_scalar(first, last, n);
+}
+
+__attribute__((target("avx2"))) auto
+count_values_avx2(const char *first, const char *last, std::size_t &n)
+    -> decltype(first) {
+  while (last - first >= 40) {
+    const __m256i v{
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first))};
+
+    if (_mm256_movemask_epi8(v) == 0) {
+      first += 32;
+      n += 32ull;
+      continue;
+    }
+
+    first += count_32_avx2(v, n);
+  }
+
+  return count_values_scalar(first, last, n);
+}
+}
+
+#endif
+
 template <std::size_t n>
-auto Decoder<n>::decode(std::istream &is, std::uint64_t &x,
-                        const unsigned char c) -> decltype(is) {
+template <std::size_t m>
+auto Decoder<n>::decode(const char *first, const char *last, std::uint64_t &x,
+                        const unsigned char c) -> decltype(first) {
   if (c > Decoder<n>::maximum_c)
-    return Decoder<n + 1ull>::decode(is, x, c);
+    return n == m ? first
+                  : Decoder<n + 1ull>::template decode<m>(first, last, x, c);
+
+  if (static_cast<std::size_t>(last - first) < Decoder<n>::s_size)
+    return first;
 
-  char s[n];
-  is.read(s, n);
   x = static_cast<std::uint64_t>(
           static_cast<unsigned char>(c ^ Decoder<n>::mask))
       << (8ull * n);
-  copy_least_significant_bytes(x, s, Decoder<n>::s_distance_bit);
-  return is;
+  copy_least_significant_bytes(x, first + 1ull, Decoder<n>::s_distance_bit);
+  return first + Decoder<n>::s_size;
 }
 
-auto Decoder<0ull>::decode(std::istream &is, std::uint64_t &x,
-                           const unsigned char c) -> decltype(is) {
+template <std::size_t m>
+auto Decoder<0ull>::decode(const char *first, const char *last,
+                           std::uint64_t &x, const unsigned char c)
+    -> decltype(first) {
   if (c > Decoder<0ull>::maximum_c)
-    return Decoder<1ull>::decode(is, x, c);
+    return 0ull == m
+               ? first
+               : Decoder<1ull>::template decode<m>(first, last, x, c);
 
   x = static_cast<unsigned char>(c);
-  return is;
+  return first + 1ull;
 }
 
-auto Decoder<1ull>::decode(std::istream &is, std::uint64_t &x,
-                           const unsigned char c) -> decltype(is) {
+template <std::size_t m>
+auto Decoder<1ull>::decode(const char *first, const char *last,
+                           std::uint64_t &x, const unsigned char c)
+    -> decltype(first) {
   if (c > Decoder<1ull>::maximum_c)
-    return Decoder<2ull>::decode(is, x, c);
+    return 1ull == m
+               ? first
+               : Decoder<2ull>::template decode<m>(first, last, x, c);
+
+  if (last - first < 2)
+    return first;
 
-  char s{0};
-  is.get(s);
   x = static_cast<std::uint64_t>(
           static_cast<unsigned char>(c ^ Decoder<1ull>::mask))
       << 8ull;
-  x |= static_cast<unsigned char>(s);
-  return is;
+  x |= static_cast<unsigned char>(first[1ull]);
+  return first + 2ull;
 }
 
-auto Decoder<7ull>::decode(std::istream &is, std::uint64_t &x,
-                           const unsigned char c) -> decltype(is) {
+template <std::size_t m>
+auto Decoder<7ull>::decode(const char *first, const char *last,
+                           std::uint64_t &x, const unsigned char c)
+    -> decltype(first) {
   if (c > Decoder<7ull>::maximum_c)
-    return Decoder<8ull>::decode(is, x, c);
+    return 7ull == m
+               ? first
+               : Decoder<8ull>::template decode<m>(first, last, x, c);
+
+  if (last - first < 8)
+    return first;
 
-  char s[7ull];
-  is.read(s, 7ull);
   x = 0ull;
-  copy_least_significant_bytes(x, s, 48ull);
-  return is;
+  copy_least_significant_bytes(x, first + 1ull, 48ull);
+  return first + 8ull;
 }
 
-auto Decoder<8ull>::decode(std::istream &is, std::uint64_t &x,
-                           const unsigned char c) -> decltype(is) {
-  char s[8ull];
-  is.read(s, 8ull);
+template <std::size_t m>
+auto Decoder<8ull>::decode(const char *first, const char *last,
+                           std::uint64_t &x, const unsigned char c)
+    -> decltype(first) {
+  if (last - first < 9)
+    return first;
+
   x = 0ull;
-  copy_least_significant_bytes(x, s, 56ull);
-  return is;
+  copy_least_significant_bytes(x, first + 1ull, 56ull);
+  return first + 9ull;
 }
 
 } // end namespace lttoolbox
@@ -19,9 +19,13 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <array>
 #include <istream>
+#include <vector>
 
+#include "float_bits.h"
 #include "mask.h"
+#include "zigzag.h"
 
 namespace lttoolbox {
 
@@ -45,16 +49,18 @@ namespace lttoolbox {
 // One can encode any binary value 64 or fewer bits in size in Apertium binary
 // format.
 //
-// Q: Why are there not overloads for smaller data types?  Is this not
-//    inefficient?
+// Q: Why are there overloads for smaller data types?  Is this function not
+//    enough?
 //
-// Is this inefficient?  Yes and no.  It is computationally inefficient, but it
-// does not affect the number of bytes used to encode a value.  That number
-// depends only on the value to be encoded.  Such overloads should be added in
-// a future version.
+// This function alone would be enough, but it would be computationally
+// inefficient for a smaller data type.  It would not affect the number of
+// bytes used to encode a value, since that number depends only on the value
+// to be encoded.  The overloads for `std::uint8_t`, `std::uint16_t`, and
+// `std::uint32_t`, which are declared after this function, avoid the
+// inefficiency.
 //
-// Q: Why is it computationally inefficient not to have overloads for smaller
-//    data types?
+// Q: Why would this function alone be computationally inefficient for a
+//    smaller data type?
 //
 // The first step of encoding a value in Apertium binary format is to determine
 // its "class".  When interpreted as an unsigned integer, a value between 0 and
@@ -64,10 +70,10 @@ namespace lttoolbox {
 // class, but a value any larger, between 2**56 and 2**64 - 1 (inclusive) is in
 // the 8th class.  While a 64-bit value could be in any one of those classes,
 // an 8-bit value, for example, could be in only the 0th or 1st class.  Thus,
-// when encoding an 8-bit value, the encoding function may make an unnecessary
-// check to determine whether the value is in the 2nd class -- this would
-// happen if the value were between 2**7 and 2**8 - 1 (inclusive).  It is
-// similar for other values less than 64 bits in size.[1]
+// when encoding an 8-bit value, the encoding function for 64-bit values would
+// make an unnecessary check to determine whether the value is in the 2nd
+// class -- this would happen if the value were between 2**7 and 2**8 - 1
+// (inclusive).  It is similar for other values less than 64 bits in size.[1]
 //
 // Q: What is the significance of a value's class, and
 // Q: how does a value affect the number of bytes used to encode it?
@@ -166,6 +172,186 @@ namespace lttoolbox {
 //
 auto decode(std::istream &is, std::uint64_t &x) -> decltype(is);
 
+// Decode a value encoded in Apertium binary format from the bytes in [first,
+// last) into `x` and then return a pointer to the byte after the value.
+//
+// This function reads only the bytes of the value itself, so it is safe to
+// call on a buffer that holds many values back to back.  If [first, last) does
+// not hold a whole value, this function returns `first` and leaves `x`
+// unchanged.  Since a whole value is always at least 1 byte in size, a return
+// value equal to `first` always means that the value was truncated.
+//
+// The `std::istream` overload above reads the value into a local buffer and
+// then calls this function, so both decode a value in exactly the same way.
+auto decode(const char *first, const char *last, std::uint64_t &x)
+    -> decltype(first);
+
+// Decode the number of values or characters that follow it from the bytes in
+// [first, last) into `n` as the overload above does, but return `first` and
+// leave `n` unchanged also if it is greater than the number of bytes after
+// it.  Every value takes at least 1 byte, so such a count is malformed, and
+// this way one read from untrusted input cannot size a huge allocation.
+auto decode_count(const char *first, const char *last, std::uint64_t &n)
+    -> decltype(first);
+
+// Decode a value as the overloads above do into `std::uint8_t`,
+// `std::uint16_t`, or `std::uint32_t`.
+//
+// Only the classes that a value of the type's width can be in are checked
+// for, so, for example, decoding a `std::uint16_t` takes at most 3
+// comparisons.  If the encoded value is in a greater class, or it is in the
+// greatest class but too large for the type, the `std::istream` overload sets
+// `failbit`, and the buffer overload returns `first`, as if the value were
+// truncated.  In both cases, `x` is left unchanged.
+template <class T>
+auto decode(std::istream &is, T &x) ->
+    typename std::enable_if<is_narrow<T>::value, std::istream &>::type;
+template <class T>
+auto decode(const char *first, const char *last, T &x) ->
+    typename std::enable_if<is_narrow<T>::value, const char *>::type;
+
+// Decode a value as the overloads above do into a `std::uint64_t` for a
+// `double` or a `std::uint32_t` for a `float`, and then map it as
+// `from_float_bits` does; see float_bits.h.  The value is bit-exact,
+// including negative zero and the payload of any NaN.
+auto decode(std::istream &is, double &x) -> decltype(is);
+auto decode(const char *first, const char *last, double &x)
+    -> decltype(first);
+auto decode(std::istream &is, float &x) -> decltype(is);
+auto decode(const char *first, const char *last, float &x) -> decltype(first);
+
+// Decode a value as the overloads above do into the unsigned type of the same
+// width as `x`, which is of a signed integer type, and then map it as
+// `from_zigzag` does; see zigzag.h.  This is the inverse of `encode_zigzag`;
+// see encode.h.  There is no `decode` overload for a signed type, so a value
+// cannot be read back in a different format from the one it was written in.
+template <class T>
+inline auto decode_zigzag(std::istream &is, T &x) ->
+    typename std::enable_if<std::is_signed<T>::value &&
+                                std::is_integral<T>::value,
+                            std::istream &>::type;
+template <class T>
+inline auto decode_zigzag(const char *first, const char *last, T &x) ->
+    typename std::enable_if<std::is_signed<T>::value &&
+                                std::is_integral<T>::value,
+                            const char *>::type;
+
+// Decode `n` values from the bytes in [first, last) into the `n` elements
+// starting at `x` and then return a pointer to the byte after the last value.
+//
+// This is equivalent to calling the overload above `n` times, but it checks
+// whether a value might be truncated only when fewer than 9 bytes remain.  If
+// [first, last) does not hold `n` whole values, or if a value does not fit in
+// the element type, this function returns `first`, and the values of the
+// elements are unspecified.  For `std::uint64_t`, which instructions are used
+// is chosen at run time; see kernel.h.
+auto decode_n(const char *first, const char *last, std::uint64_t *x,
+              const std::size_t n) -> decltype(first);
+auto decode_n(const char *first, const char *last, std::uint32_t *x,
+              const std::size_t n) -> decltype(first);
+
+// Decode `n` values as above and append them to `xs`.  If this function
+// returns `first`, `xs` is left as it was.
+auto decode_n(const char *first, const char *last,
+              std::vector<std::uint64_t> &xs, const std::size_t n)
+    -> decltype(first);
+auto decode_n(const char *first, const char *last,
+              std::vector<std::uint32_t> &xs, const std::size_t n)
+    -> decltype(first);
+
+// Decode `n` values as `decode_n` does and then map each as `decode_zigzag`
+// does.  This is the inverse of `encode_n_zigzag`; see encode.h.
+auto decode_n_zigzag(const char *first, const char *last, std::int64_t *x,
+                     const std::size_t n) -> decltype(first);
+auto decode_n_zigzag(const char *first, const char *last, std::int32_t *x,
+                     const std::size_t n) -> decltype(first);
+auto decode_n_zigzag(const char *first, const char *last,
+                     std::vector<std::int64_t> &xs, const std::size_t n)
+    -> decltype(first);
+auto decode_n_zigzag(const char *first, const char *last,
+                     std::vector<std::int32_t> &xs, const std::size_t n)
+    -> decltype(first);
+
+// Decode the first `n` values in `s`, which must hold at least `n` whole
+// values, at compile time.  This is the inverse of `encode_array`; see
+// encode.h.
+template <std::size_t n, std::size_t N>
+constexpr auto decode_array(const std::array<char, N> &s)
+    -> std::array<std::uint64_t, n>;
+
+// Return the number of whole values in [first, last).
+//
+// Only the first byte of each value is inspected, and runs of values in the
+// 0th and 1st classes are skipped several at a time, so this is much faster
+// than decoding the values.  Which instructions are used is chosen at run
+// time; see kernel.h.
+auto count_values(const char *first, const char *last) -> std::size_t;
+
+// Return a pointer to the first value in [first, last) that is truncated, or,
+// if there is none, `last`.
+//
+// Every byte is a valid first byte, so a value is malformed only if it is
+// truncated, and only the last value in a buffer can be.  This function
+// inspects the bytes as `count_values` does.
+auto validate(const char *first, const char *last) -> decltype(first);
+
+// Validate as above, and also add the number of whole values before the
+// returned pointer to `n`, so that a buffer can be both validated and counted
+// in one pass.
+auto validate(const char *first, const char *last, std::size_t &n)
+    -> decltype(first);
+
+template <std::size_t n, std::size_t N>
+constexpr auto decode_array(const std::array<char, N> &s)
+    -> std::array<std::uint64_t, n> {
+  ConstexprArray<std::uint64_t, n> x{};
+  std::size_t i{0ull};
+
+  for (std::size_t k{0ull}; k != n; ++k) {
+    const auto c = static_cast<unsigned char>(s[i++]);
+    const std::size_t m{get_class(c)};
+    std::uint64_t y{static_cast<unsigned char>(c ^ get_mask(m))};
+
+    for (std::size_t j{0ull}; j != m; ++j)
+      y = y << 8ull | static_cast<unsigned char>(s[i++]);
+
+    x.a[k] = y;
+  }
+
+  return x.to_array();
+}
+
+template <class T>
+auto decode_zigzag(std::istream &is, T &x) ->
+    typename std::enable_if<std::is_signed<T>::value &&
+                                std::is_integral<T>::value,
+                            std::istream &>::type {
+  // `std::int64_t` may be `long` and `long long` may be another type of the
+  // same width, whose unsigned counterpart has no overload.
+  typename std::conditional<sizeof(T) == 8ull, std::uint64_t,
+                            typename std::make_unsigned<T>::type>::type y{};
+
+  if (decode(is, y))
+    x = from_zigzag<T>(y);
+
+  return is;
+}
+
+template <class T>
+auto decode_zigzag(const char *first, const char *last, T &x) ->
+    typename std::enable_if<std::is_signed<T>::value &&
+                                std::is_integral<T>::value,
+                            const char *>::type {
+  typename std::conditional<sizeof(T) == 8ull, std::uint64_t,
+                            typename std::make_unsigned<T>::type>::type y{};
+  const char *const s{decode(first, last, y)};
+
+  if (s != first)
+    x = from_zigzag<T>(y);
+
+  return s;
+}
+
 namespace {
 
 // Return the maximum value of the first byte, when interpreted as an unsigned
@@ -180,26 +366,35 @@ static constexpr unsigned char get_maximum_c(const unsigned char mask) {
       (static_cast<unsigned char>(~mask) + 1ull) >> 1ull);
 }
 
+// Decode a value whose first byte is `c` if it is in the nth class, or else
+// try the next class.  If it is in a class greater than m, return `first`.
 template <std::size_t n> class Decoder {
 public:
-  static inline auto decode(std::istream &is, std::uint64_t &x,
-                            const unsigned char c) -> decltype(is);
+  template <std::size_t m = 8ull>
+  static inline auto decode(const char *first, const char *last,
+                            std::uint64_t &x, const unsigned char c)
+      -> decltype(first);
   static constexpr unsigned char mask = get_mask(n);
   static constexpr unsigned char maximum_c = get_maximum_c(Decoder<n>::mask);
   static constexpr std::size_t s_distance_bit = 8ull * (n - 1ull);
+  static constexpr std::size_t s_size = n + 1ull;
 };
 
 template <> class Decoder<0ull> {
 public:
-  static inline auto decode(std::istream &is, std::uint64_t &x,
-                            const unsigned char c) -> decltype(is);
+  template <std::size_t m = 8ull>
+  static inline auto decode(const char *first, const char *last,
+                            std::uint64_t &x, const unsigned char c)
+      -> decltype(first);
   static constexpr unsigned char maximum_c = get_maximum_c(get_mask(0ull));
 };
 
 template <> class Decoder<1ull> {
 public:
-  static inline auto decode(std::istream &is, std::uint64_t &x,
-                            const unsigned char c) -> decltype(is);
+  template <std::size_t m = 8ull>
+  static inline auto decode(const char *first, const char *last,
+                            std::uint64_t &x, const unsigned char c)
+      -> decltype(first);
   static constexpr unsigned char mask = get_mask(1ull);
   static constexpr unsigned char maximum_c =
       get_maximum_c(Decoder<1ull>::mask);
@@ -207,17 +402,77 @@ public:
 
 template <> class Decoder<7ull> {
 public:
-  static inline auto decode(std::istream &is, std::uint64_t &x,
-                            const unsigned char c) -> decltype(is);
+  template <std::size_t m = 8ull>
+  static inline auto decode(const char *first, const char *last,
+                            std::uint64_t &x, const unsigned char c)
+      -> decltype(first);
   static constexpr unsigned char maximum_c = get_maximum_c(get_mask(7ull));
 };
 
 template <> class Decoder<8ull> {
 public:
-  static inline auto decode(std::istream &is, std::uint64_t &x,
-                            const unsigned char c) -> decltype(is);
+  template <std::size_t m = 8ull>
+  static inline auto decode(const char *first, const char *last,
+                            std::uint64_t &x, const unsigned char c)
+      -> decltype(first);
 };
 
+// The class of each possible first byte, as computed by `get_class`.
+class ClassTable {
+public:
+  constexpr ClassTable() : n{} {
+    for (std::size_t c{0ull}; c != 256ull; ++c)
+      n[c] = get_class(c);
+  }
+
+  unsigned char n[256ull];
+};
+
+static constexpr ClassTable class_table{};
+
+// Return the 8 bytes starting at `s` interpreted as a bytewise big-endian
+// unsigned integer.
+//
+// Compilers recognize this pattern and emit a single load and byte swap.
+static inline std::uint64_t load_big_endian(const char *s) {
+  const auto *const u = reinterpret_cast<const unsigned char *>(s);
+  return static_cast<std::uint64_t>(u[0ull]) << 56ull |
+         static_cast<std::uint64_t>(u[1ull]) << 48ull |
+         static_cast<std::uint64_t>(u[2ull]) << 40ull |
+         static_cast<std::uint64_t>(u[3ull]) << 32ull |
+         static_cast<std::uint64_t>(u[4ull]) << 24ull |
+         static_cast<std::uint64_t>(u[5ull]) << 16ull |
+         static_cast<std::uint64_t>(u[6ull]) << 8ull |
+         static_cast<std::uint64_t>(u[7ull]);
+}
+
+// Return the 8 bytes starting at `s` interpreted as a bytewise little-endian
+// unsigned integer, which is a single load on x86.
+static inline std::uint64_t load_little_endian(const char *s) {
+  const auto *const u = reinterpret_cast<const unsigned char *>(s);
+  return static_cast<std::uint64_t>(u[0ull]) |
+         static_cast<std::uint64_t>(u[1ull]) << 8ull |
+         static_cast<std::uint64_t>(u[2ull]) << 16ull |
+         static_cast<std::uint64_t>(u[3ull]) << 24ull |
+         static_cast<std::uint64_t>(u[4ull]) << 32ull |
+         static_cast<std::uint64_t>(u[5ull]) << 40ull |
+         static_cast<std::uint64_t>(u[6ull]) << 48ull |
+         static_cast<std::uint64_t>(u[7ull]) << 56ull;
+}
+
+// Return the value in the nth class whose first byte is `c` and whose
+// following n bytes are the most significant bytes of `s`.
+//
+// This does not branch on `n`.  Each shift by 8 * n bits is split in two so
+// that no shift is by 64 bits, which would be undefined.  For the 7th and 8th
+// classes, `0x7f >> n` leaves none of the first byte's bits.
+static inline std::uint64_t get_x(const unsigned char c, const std::size_t n,
+                                  const std::uint64_t s) {
+  const std::uint64_t literal_c{c & (0x7full >> n)};
+  return literal_c << (4ull * n) << (4ull * n) |
+         s >> (32ull - 4ull * n) >> (32ull - 4ull * n);
+}
+
 static inline void copy_least_significant_bytes(std::uint64_t &x,
                                                 const char *s,
                                                 std::size_t s_distance_bit) {
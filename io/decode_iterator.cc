@@ -0,0 +1,136 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "decode_iterator.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <unistd.h>
+
+#include "decode.h"
+
+namespace lttoolbox {
+
+DecodeIterator::DecodeIterator()
+    : range{nullptr}, x{nullptr}, x_last{nullptr} {}
+
+DecodeIterator::DecodeIterator(DecodedRange &range)
+    : range{&range}, x{nullptr}, x_last{nullptr} {
+  next();
+}
+
+auto operator==(const DecodeIterator &a, const DecodeIterator &b) -> bool {
+  return a.range == b.range;
+}
+
+auto operator!=(const DecodeIterator &a, const DecodeIterator &b) -> bool {
+  return a.range != b.range;
+}
+
+void DecodeIterator::next() {
+  if (!range->decode_window(x, x_last))
+    *this = DecodeIterator{};
+}
+
+constexpr std::size_t DecodedRange::buffer_size;
+constexpr std::size_t DecodedRange::window_size;
+
+DecodedRange::DecodedRange(std::istream &is)
+    : source{Source::stream}, is{&is}, fd{-1}, buffer(buffer_size),
+      window(window_size), s{buffer.data()}, last{s}, eof{false},
+      good_{true} {}
+
+DecodedRange::DecodedRange(const int fd)
+    : source{Source::file_descriptor}, is{nullptr}, fd{fd},
+      buffer(buffer_size), window(window_size), s{buffer.data()}, last{s},
+      eof{false}, good_{true} {}
+
+DecodedRange::DecodedRange(const char *first, const char *last)
+    : source{Source::buffer}, is{nullptr}, fd{-1}, buffer{},
+      window(window_size), s{first}, last{last}, eof{true}, good_{true} {}
+
+auto DecodedRange::begin() -> DecodeIterator { return DecodeIterator{*this}; }
+
+auto DecodedRange::end() -> DecodeIterator { return DecodeIterator{}; }
+
+auto DecodedRange::good() const -> bool { return good_; }
+
+auto DecodedRange::decode_window(const std::uint64_t *&x,
+                                 const std::uint64_t *&x_last) -> bool {
+  if (static_cast<std::size_t>(last - s) < 9ull * window_size)
+    read();
+
+  // A value is at most 9 bytes, so there are at least this many whole values
+  // left, and they can be decoded without counting them first.  Only the last
+  // few bytes need to be counted.
+  std::size_t n{std::min<std::size_t>((last - s) / 9, window_size)};
+
+  if (n == 0ull) {
+    validate(s, last, n);
+
+    if (n == 0ull) {
+      if (s != last)
+        good_ = false;
+
+      return false;
+    }
+  }
+
+  s = decode_n(s, last, window.data(), n);
+  x = window.data();
+  x_last = x + n;
+  return true;
+}
+
+void DecodedRange::read() {
+  if (eof)
+    return;
+
+  const std::size_t size = last - s;
+  std::memmove(buffer.data(), s, size);
+  s = buffer.data();
+  char *first{buffer.data() + size};
+  char *const buffer_last{buffer.data() + buffer.size()};
+
+  if (source == Source::stream) {
+    is->read(first, buffer_last - first);
+    first += is->gcount();
+    eof = first != buffer_last;
+
+    if (is->bad())
+      good_ = false;
+  } else {
+    while (first != buffer_last) {
+      const auto n = ::read(fd, first, buffer_last - first);
+
+      if (n < 0 && errno == EINTR)
+        continue;
+
+      if (n <= 0) {
+        eof = true;
+        good_ = n == 0 && good_;
+        break;
+      }
+
+      first += n;
+    }
+  }
+
+  last = first;
+}
+
+} // end namespace lttoolbox
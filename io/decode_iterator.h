@@ -0,0 +1,141 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_DECODE_ITERATOR_H
+#define APERTIUM_LTTOOLBOX_DECODE_ITERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <istream>
+#include <iterator>
+#include <vector>
+
+namespace lttoolbox {
+
+class DecodedRange;
+
+// An input iterator over the values of a `DecodedRange`.
+//
+// The values are decoded a window at a time, so incrementing the iterator
+// within a window only compares and increments a pointer.  A
+// value-initialized iterator is the end iterator.
+class DecodeIterator {
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = std::uint64_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const std::uint64_t *;
+  using reference = const std::uint64_t &;
+
+  DecodeIterator();
+  explicit DecodeIterator(DecodedRange &range);
+
+  inline auto operator*() const -> reference;
+  inline auto operator->() const -> pointer;
+  inline auto operator++() -> DecodeIterator &;
+  inline auto operator++(int) -> DecodeIterator;
+
+  friend auto operator==(const DecodeIterator &a, const DecodeIterator &b)
+      -> bool;
+  friend auto operator!=(const DecodeIterator &a, const DecodeIterator &b)
+      -> bool;
+
+private:
+  // Decode the next window, or, if there is none, become the end iterator.
+  void next();
+
+  DecodedRange *range;
+  const std::uint64_t *x;
+  const std::uint64_t *x_last;
+};
+
+// The values encoded in Apertium binary format in a `std::istream`, a file
+// descriptor or a buffer, as a range of `DecodeIterator`s for standard
+// algorithms.
+//
+// Bytes are read from a stream or file descriptor into a buffer of
+// `buffer_size`, and values are decoded from it with `decode_n` up to
+// `window_size` at a time.
+// A stream is read to its end, which sets its eofbit and failbit.  A buffer is
+// decoded in place.
+//
+// Like `std::istream_iterator`, `begin` starts decoding, so it should be
+// called once, and every copy of an iterator but the last incremented is
+// invalidated.  A `DecodedRange` must not outlive what it reads from, nor be
+// destroyed before its iterators.
+class DecodedRange {
+public:
+  static constexpr std::size_t buffer_size{1ull << 16ull};
+  static constexpr std::size_t window_size{1ull << 11ull};
+
+  explicit DecodedRange(std::istream &is);
+  explicit DecodedRange(const int fd);
+  DecodedRange(const char *first, const char *last);
+  DecodedRange(const DecodedRange &) = delete;
+  auto operator=(const DecodedRange &) -> DecodedRange & = delete;
+
+  auto begin() -> DecodeIterator;
+  auto end() -> DecodeIterator;
+
+  // Return false if the last value was truncated or a read failed, after
+  // which there are no more values.
+  auto good() const -> bool;
+
+private:
+  friend class DecodeIterator;
+
+  enum class Source { stream, file_descriptor, buffer };
+
+  // Decode the next window into [x, x_last) and then return true, or, if
+  // there are no whole values left, return false.
+  auto decode_window(const std::uint64_t *&x, const std::uint64_t *&x_last)
+      -> bool;
+
+  // Keep the bytes in [s, last), and then read as many more as fit after
+  // them.
+  void read();
+
+  Source source;
+  std::istream *is;
+  int fd;
+  std::vector<char> buffer;
+  std::vector<std::uint64_t> window;
+  const char *s;
+  const char *last;
+  bool eof;
+  bool good_;
+};
+
+auto DecodeIterator::operator*() const -> reference { return *x; }
+
+auto DecodeIterator::operator->() const -> pointer { return x; }
+
+auto DecodeIterator::operator++() -> DecodeIterator & {
+  if (++x == x_last)
+    next();
+
+  return *this;
+}
+
+auto DecodeIterator::operator++(int) -> DecodeIterator {
+  DecodeIterator previous{*this};
+  ++*this;
+  return previous;
+}
+
+} // end namespace lttoolbox
+
+#endif
@@ -0,0 +1,207 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "delta.h"
+#include "decode.h"
+#include "encode.h"
+#include "kernel.h"
+
+namespace lttoolbox {
+
+namespace {
+
+// Replace each of the `n` values starting at `x` with the sum of it and all
+// the values before it.
+static void prefix_sum_scalar(std::uint64_t *x, const std::size_t n);
+
+#if HAVE_X86_SIMD
+
+// Sum 2 or 4 values at a time, respectively.  Each vector of values is summed
+// independently of the ones before it, and then the carry from them is added,
+// so the only dependency between iterations is one addition.
+__attribute__((target("sse2"))) static void
+prefix_sum_sse2(std::uint64_t *x, const std::size_t n);
+__attribute__((target("avx2"))) static void
+prefix_sum_avx2(std::uint64_t *x, const std::size_t n);
+
+#endif
+
+// The implementation of the prefix sum for each `Kernel`.
+static void (*const prefix_sum_kernels[kernel_count])(std::uint64_t *x,
+                                                      const std::size_t n){
+    prefix_sum_scalar,
+
+#if HAVE_X86_SIMD
+
+    prefix_sum_sse2, prefix_sum_avx2, prefix_sum_scalar
+
+#else
+
+    prefix_sum_scalar, prefix_sum_scalar, prefix_sum_scalar
+
+#endif
+};
+}
+
+auto encode_delta(char *s, const std::uint64_t *x, const std::size_t n)
+    -> decltype(s) {
+  s = encode(s, std::uint64_t{n});
+  std::uint64_t previous{0ull};
+
+  for (const std::uint64_t *const x_last{x + n}; x != x_last; ++x) {
+    s = encode(s, *x - previous);
+    previous = *x;
+  }
+
+  return s;
+}
+
+auto decode_delta(const char *first, const char *last,
+                  std::vector<std::uint64_t> &xs) -> decltype(first) {
+  std::uint64_t n{0ull};
+  const char *const s{decode_count(first, last, n)};
+
+  if (s == first)
+    return first;
+
+  const std::size_t size{xs.size()};
+  const char *const next{decode_n(s, last, xs, n)};
+
+  if (next == s && n != 0ull)
+    return first;
+
+  prefix_sum_kernels[static_cast<std::size_t>(get_kernel(Operation::decode))](
+      xs.data() + size, n);
+  return next;
+}
+
+DeltaIterator::DeltaIterator()
+    : s{nullptr}, last{nullptr}, n{0ull}, x{0ull}, good_{true} {}
+
+DeltaIterator::DeltaIterator(const char *first, const char *last)
+    : s{first}, last{last}, n{0ull}, x{0ull}, good_{true} {
+  std::uint64_t n_{0ull};
+  s = decode(first, last, n_);
+
+  if (s == first) {
+    good_ = false;
+    return;
+  }
+
+  n = n_;
+
+  if (n != 0ull)
+    decode_next();
+}
+
+auto DeltaIterator::operator*() const -> reference { return x; }
+
+auto DeltaIterator::operator->() const -> pointer { return &x; }
+
+auto DeltaIterator::operator++() -> DeltaIterator & {
+  if (--n != 0ull)
+    decode_next();
+
+  return *this;
+}
+
+auto DeltaIterator::operator++(int) -> DeltaIterator {
+  DeltaIterator previous{*this};
+  ++*this;
+  return previous;
+}
+
+auto DeltaIterator::size() const -> std::size_t { return n; }
+
+auto DeltaIterator::tell() const -> const char * { return s; }
+
+auto DeltaIterator::good() const -> bool { return good_; }
+
+auto operator==(const DeltaIterator &a, const DeltaIterator &b) -> bool {
+  return a.n == b.n;
+}
+
+auto operator!=(const DeltaIterator &a, const DeltaIterator &b) -> bool {
+  return a.n != b.n;
+}
+
+void DeltaIterator::decode_next() {
+  std::uint64_t y{0ull};
+  const char *const next{decode(s, last, y)};
+
+  if (next == s) {
+    n = 0ull;
+    good_ = false;
+    return;
+  }
+
+  s = next;
+  x += y;
+}
+
+namespace {
+
+void prefix_sum_scalar(std::uint64_t *x, const std::size_t n) {
+  std::uint64_t sum{0ull};
+
+  for (std::uint64_t *const x_last{x + n}; x != x_last; ++x)
+    *x = sum += *x;
+}
+
+#if HAVE_X86_SIMD
+
+void prefix_sum_sse2(std::uint64_t *x, const std::size_t n) {
+  std::uint64_t *const x_last{x + n};
+  __m128i carry{_mm_setzero_si128()};
+
+  for (; x_last - x >= 2; x += 2) {
+    __m128i v{_mm_loadu_si128(reinterpret_cast<const __m128i *>(x))};
+    v = _mm_add_epi64(v, _mm_slli_si128(v, 8));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(x), _mm_add_epi64(v, carry));
+    carry = _mm_add_epi64(carry, _mm_unpackhi_epi64(v, v));
+  }
+
+  if (x != x_last)
+    *x += static_cast<std::uint64_t>(_mm_cvtsi128_si64(carry));
+}
+
+void prefix_sum_avx2(std::uint64_t *x, const std::size_t n) {
+  std::uint64_t *const x_last{x + n};
+  __m256i carry{_mm256_setzero_si256()};
+
+  for (; x_last - x >= 4; x += 4) {
+    // Sum within each 128-bit lane, and then add the sum of the lower lane to
+    // both values of the upper one.
+    __m256i v{_mm256_loadu_si256(reinterpret_cast<const __m256i *>(x))};
+    v = _mm256_add_epi64(v, _mm256_slli_si256(v, 8));
+    v = _mm256_add_epi64(
+        v, _mm256_blend_epi32(_mm256_setzero_si256(),
+                              _mm256_permute4x64_epi64(v, 0x50), 0xf0));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(x),
+                        _mm256_add_epi64(v, carry));
+    carry = _mm256_add_epi64(carry, _mm256_permute4x64_epi64(v, 0xff));
+  }
+
+  std::uint64_t sum{static_cast<std::uint64_t>(
+      _mm_cvtsi128_si64(_mm256_castsi256_si128(carry)))};
+
+  for (; x != x_last; ++x)
+    *x = sum += *x;
+}
+
+#endif
+}
+
+} // end namespace lttoolbox
@@ -0,0 +1,99 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_DELTA_H
+#define APERTIUM_LTTOOLBOX_DELTA_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <iterator>
+#include <vector>
+
+namespace lttoolbox {
+
+// Encode the `n` values starting at `x` as a sequence and then return a
+// pointer to the byte after it.
+//
+// A sequence is the number of values, then the first value, and then the
+// difference between each value and the one before it, each encoded in
+// Apertium binary format.  The values should be sorted in nondecreasing
+// order, in which case the differences are usually much smaller than the
+// values themselves.  Any values can be encoded, but each value less than the
+// one before it takes 9 bytes.  `s` must point to at least 9 * (`n` + 1)
+// writable bytes.
+auto encode_delta(char *s, const std::uint64_t *x, const std::size_t n)
+    -> decltype(s);
+
+// Decode a sequence encoded by `encode_delta` from the bytes in [first, last),
+// append its values to `xs`, and then return a pointer to the byte after it.
+//
+// The differences are decoded with `decode_n` and then summed in place.  If
+// [first, last) does not hold a whole sequence, this function returns `first`
+// and leaves `xs` as it was.
+auto decode_delta(const char *first, const char *last,
+                  std::vector<std::uint64_t> &xs) -> decltype(first);
+
+// An input iterator over the values of a sequence encoded by `encode_delta`,
+// which decodes them one at a time.
+//
+// A value-initialized iterator is the end iterator.  An iterator over a
+// sequence becomes equal to it after the last value, or as soon as a value is
+// truncated, in which case `good` returns false.
+class DeltaIterator {
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = std::uint64_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const std::uint64_t *;
+  using reference = const std::uint64_t &;
+
+  DeltaIterator();
+  DeltaIterator(const char *first, const char *last);
+
+  auto operator*() const -> reference;
+  auto operator->() const -> pointer;
+  auto operator++() -> DeltaIterator &;
+  auto operator++(int) -> DeltaIterator;
+
+  // The number of values left, including the current one.
+  auto size() const -> std::size_t;
+
+  // A pointer to the byte after the last value decoded.  After the end of a
+  // sequence, this is the byte after the sequence.
+  auto tell() const -> const char *;
+
+  auto good() const -> bool;
+
+  friend auto operator==(const DeltaIterator &a, const DeltaIterator &b)
+      -> bool;
+  friend auto operator!=(const DeltaIterator &a, const DeltaIterator &b)
+      -> bool;
+
+private:
+  // Decode the next difference, or, if it is truncated, become the end
+  // iterator.
+  void decode_next();
+
+  const char *s;
+  const char *last;
+  std::size_t n;
+  std::uint64_t x;
+  bool good_;
+};
+
+} // end namespace lttoolbox
+
+#endif
@@ -14,51 +14,254 @@
 // along with io.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "encode.h"
+#include "kernel.h"
+#include "streambuf.h"
+
+#include <algorithm>
 
 namespace lttoolbox {
 
+namespace {
+
+// Encode `x` directly into the put area of the buffer of `os` and then return
+// true, or, if there are not 9 bytes left in the put area, return false
+// without inserting anything.
+//
+// This skips the sentry and the virtual call of `std::ostream::write`.  The
+// sentry would flush a tied stream first, and a stream with `unitbuf` set
+// after, so false is returned for those.
+template <class T>
+static inline auto encode_buffered(std::ostream &os, const T &x) -> bool;
+
+// Encode `x` as `encode` does, but look up the class from the number of
+// significant bits instead of comparing `x` against each
+// `Encoder<n>::maximum_x` in turn.
+static inline auto encode_branchless(char *s, const std::uint64_t x)
+    -> decltype(s);
+
+static auto encode_n_scalar(char *s, const std::uint64_t *x,
+                            const std::size_t n) -> decltype(s);
+
+// Encode each value with `encode_branchless`.
+static auto encode_n_branchless(char *s, const std::uint64_t *x,
+                                const std::size_t n) -> decltype(s);
+
+#if HAVE_X86_SIMD
+
+__attribute__((target("bmi,bmi2,lzcnt"))) static auto
+encode_n_bmi2(char *s, const std::uint64_t *x, const std::size_t n)
+    -> decltype(s);
+
+#endif
+
+// The implementation of `encode_n` for each `Kernel`.
+//
+// Encoding has no vector kernel.  Runs of values in the 0th class are too
+// short in compiled transducers for narrowing 16 or 32 values at once to pay
+// for the check of every block, so on benchio both such kernels were slower
+// than encoding value by value.  The SSE4.1 and AVX2 kernels use the
+// branchless path instead, which is the fastest one that needs no BMI2.
+static auto (*const encode_n_kernels[kernel_count])(char *s,
+                                                    const std::uint64_t *x,
+                                                    const std::size_t n)
+    -> decltype(s){
+    encode_n_scalar,
+
+#if HAVE_X86_SIMD
+
+    encode_n_branchless, encode_n_branchless, encode_n_bmi2
+
+#else
+
+    encode_n_scalar, encode_n_scalar, encode_n_scalar
+
+#endif
+};
+}
+
 auto encode(std::ostream &os, const std::uint64_t &x) -> decltype(os) {
-  return Encoder<0ull>::encode(os, x);
+  if (encode_buffered(os, x))
+    return os;
+
+  char s[9ull];
+  return os.write(s, encode(s, x) - s);
+}
+
+auto encode(char *s, const std::uint64_t &x) -> decltype(s) {
+#if ENABLE_BRANCHLESS_ENCODE
+
+  return encode_branchless(s, x);
+
+#else
+
+  return Encoder<0ull>::encode(s, x);
+
+#endif
+}
+
+auto encode(std::ostream &os, const double &x) -> decltype(os) {
+  return encode(os, to_float_bits(x));
+}
+
+auto encode(char *s, const double &x) -> decltype(s) {
+  return encode(s, to_float_bits(x));
+}
+
+auto encode(std::ostream &os, const float &x) -> decltype(os) {
+  return encode(os, to_float_bits(x));
+}
+
+auto encode(char *s, const float &x) -> decltype(s) {
+  return encode(s, to_float_bits(x));
+}
+
+template <class T>
+auto encode(std::ostream &os, const T &x) ->
+    typename std::enable_if<is_narrow<T>::value, std::ostream &>::type {
+  if (encode_buffered(os, x))
+    return os;
+
+  char s[9ull];
+  return os.write(s, encode(s, x) - s);
+}
+
+template <class T>
+auto encode(char *s, const T &x) ->
+    typename std::enable_if<is_narrow<T>::value, char *>::type {
+#if ENABLE_BRANCHLESS_ENCODE
+
+  return encode_branchless(s, x);
+
+#else
+
+  return Encoder<0ull>::template encode<get_maximum_class(8ull * sizeof(T))>(
+      s, x);
+
+#endif
+}
+
+template auto encode(std::ostream &os, const std::uint8_t &x)
+    -> std::ostream &;
+template auto encode(std::ostream &os, const std::uint16_t &x)
+    -> std::ostream &;
+template auto encode(std::ostream &os, const std::uint32_t &x)
+    -> std::ostream &;
+template auto encode(char *s, const std::uint8_t &x) -> char *;
+template auto encode(char *s, const std::uint16_t &x) -> char *;
+template auto encode(char *s, const std::uint32_t &x) -> char *;
+
+auto encode_n(char *s, const std::uint64_t *x, const std::size_t n)
+    -> decltype(s) {
+  return encode_n_kernels[static_cast<std::size_t>(
+      get_kernel(Operation::encode))](s, x, n);
+}
+
+auto encode_n_zigzag(char *s, const std::int64_t *x, const std::size_t n)
+    -> decltype(s) {
+  // Map the values a block at a time so that the mapped values stay in the
+  // cache and each block is encoded by the kernel chosen at run time.
+  std::uint64_t y[256ull];
+
+  for (std::size_t i{0ull}; i != n;) {
+    const std::size_t m{std::min<std::size_t>(n - i, 256ull)};
+
+    for (std::size_t j{0ull}; j != m; ++j)
+      y[j] = to_zigzag(x[i + j]);
+
+    s = encode_n(s, y, m);
+    i += m;
+  }
+
+  return s;
+}
+
+namespace {
+
+template <class T> auto encode_buffered(std::ostream &os, const T &x) -> bool {
+  char *const s{StreambufAccess::get_put_area(os, 9)};
+
+  if (s == nullptr)
+    return false;
+
+  StreambufAccess::bump_put(*os.rdbuf(), encode(s, x) - s);
+  return true;
+}
+
+auto encode_branchless(char *s, const std::uint64_t x) -> decltype(s) {
+  // Write the first byte and all 8 following bytes, whatever the class is,
+  // with the n literal bytes of `x` first.  Each shift by 8 * n bits is split
+  // in two so that no shift is by 64 bits.
+  const std::size_t n{bit_length_table.n[get_bit_length(x)]};
+  *s = get_mask(n) | x >> (4ull * n) >> (4ull * n);
+  store_big_endian(s + 1ull, x << (32ull - 4ull * n) << (32ull - 4ull * n));
+  return s + 1ull + n;
+}
+
+auto encode_n_scalar(char *s, const std::uint64_t *x, const std::size_t n)
+    -> decltype(s) {
+  for (const std::uint64_t *const x_last{x + n}; x != x_last; ++x)
+    s = encode(s, *x);
+
+  return s;
+}
+
+auto encode_n_branchless(char *s, const std::uint64_t *x, const std::size_t n)
+    -> decltype(s) {
+  for (const std::uint64_t *const x_last{x + n}; x != x_last; ++x)
+    s = encode_branchless(s, *x);
+
+  return s;
+}
+
+#if HAVE_X86_SIMD
+
+__attribute__((target("bmi,bmi2,lzcnt"))) auto
+encode_n_bmi2(char *s, const std::uint64_t *x, const std::size_t n)
+    -> decltype(s) {
+  for (const std::uint64_t *const x_last{x + n}; x != x_last; ++x)
+    s = encode_branchless(s, *x);
+
+  return s;
+}
+
+#endif
 }
 
 template <std::size_t n>
-auto Encoder<n>::encode(std::ostream &os, const std::uint64_t &x)
-    -> decltype(os) {
-  if (x > Encoder<n>::maximum_x)
-    return Encoder<n + 1ull>::encode(os, x);
+template <std::size_t m>
+auto Encoder<n>::encode(char *s, const std::uint64_t &x) -> decltype(s) {
+  if (n != m && x > Encoder<n>::maximum_x)
+    return Encoder<n + 1ull>::template encode<m>(s, x);
 
-  char s[Encoder<n>::s_size];
   copy_least_significant_bytes(s + n, s, x);
   s[0ull] |= Encoder<n>::mask;
-  return os.write(s, Encoder<n>::s_size);
+  return s + Encoder<n>::s_size;
 }
 
-auto Encoder<0ull>::encode(std::ostream &os, const std::uint64_t &x)
-    -> decltype(os) {
-  auto y = maximum_x;
-  if (x > Encoder<0ull>::maximum_x)
-    return Encoder<1ull>::encode(os, x);
+template <std::size_t m>
+auto Encoder<0ull>::encode(char *s, const std::uint64_t &x) -> decltype(s) {
+  if (0ull != m && x > Encoder<0ull>::maximum_x)
+    return Encoder<1ull>::template encode<m>(s, x);
 
-  return os.put(x);
+  *s = x;
+  return s + 1ull;
 }
 
-auto Encoder<7ull>::encode(std::ostream &os, const std::uint64_t &x)
-    -> decltype(os) {
-  if (x > Encoder<7ull>::maximum_x)
-    return Encoder<8ull>::encode(os, x);
+template <std::size_t m>
+auto Encoder<7ull>::encode(char *s, const std::uint64_t &x) -> decltype(s) {
+  if (7ull != m && x > Encoder<7ull>::maximum_x)
+    return Encoder<8ull>::template encode<m>(s, x);
 
-  char s[8ull];
   copy_least_significant_bytes(s + 7ull, s + 1ull, x);
   *s = Encoder<7ull>::mask;
-  return os.write(s, 8ull);
+  return s + 8ull;
 }
 
-auto Encoder<8ull>::encode(std::ostream &os, const std::uint64_t &x)
-    -> decltype(os) {
-  char s[9ull];
+template <std::size_t m>
+auto Encoder<8ull>::encode(char *s, const std::uint64_t &x) -> decltype(s) {
   copy_least_significant_bytes(s + 8ull, s + 1ull, x);
   *s = Encoder<8ull>::mask;
-  return os.write(s, 9ull);
+  return s + 9ull;
 }
 
 } // end namespace lttoolbox
@@ -19,15 +19,121 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <array>
 #include <ostream>
 #include <string>
 
+#include "float_bits.h"
 #include "mask.h"
+#include "zigzag.h"
 
 namespace lttoolbox {
 
 auto encode(std::ostream &os, const std::uint64_t &x) -> decltype(os);
 
+// Encode `x` in Apertium binary format into the bytes starting at `s` and then
+// return a pointer to the byte after the value.
+//
+// The value takes between 1 and 9 bytes, depending only on `x`, but this
+// function may overwrite up to `encode_overwrite_size` bytes after it, so `s`
+// must point to at least 9 writable bytes.  Each value overwrites only bytes
+// that the next one is written over, so a buffer for several values needs
+// only `encode_overwrite_size` bytes more than they take.  The `std::ostream`
+// overload above encodes the value into a local buffer with this function and
+// then writes it to the stream in one call.
+auto encode(char *s, const std::uint64_t &x) -> decltype(s);
+
+// The most bytes after a value that `encode` may overwrite, which is when a
+// value in the 0th class is written as 9 bytes.
+static constexpr std::size_t encode_overwrite_size{8ull};
+
+// Encode `x` as the overloads above do, where `x` is a `std::uint8_t`,
+// `std::uint16_t`, or `std::uint32_t`.  Only the classes that a value of the
+// type's width can be in are checked for.
+template <class T>
+auto encode(std::ostream &os, const T &x) ->
+    typename std::enable_if<is_narrow<T>::value, std::ostream &>::type;
+template <class T>
+auto encode(char *s, const T &x) ->
+    typename std::enable_if<is_narrow<T>::value, char *>::type;
+
+// Map `x` to an unsigned value as `to_float_bits` does and then encode it as
+// the overloads above do; see float_bits.h.  Common weights such as 0.0 and
+// small integers take 1 or 2 bytes rather than 9 or 5.
+auto encode(std::ostream &os, const double &x) -> decltype(os);
+auto encode(char *s, const double &x) -> decltype(s);
+auto encode(std::ostream &os, const float &x) -> decltype(os);
+auto encode(char *s, const float &x) -> decltype(s);
+
+// Encode `x`, which is of any other integer type, such as `int`, as the
+// `std::uint64_t` that it converts to, so that a negative value takes 9 bytes.
+// This keeps every integer argument in the unsigned format; a signed value is
+// encoded compactly only by `encode_zigzag`.
+template <class T>
+inline auto encode(std::ostream &os, const T &x) ->
+    typename std::enable_if<is_converted_integer<T>::value,
+                            std::ostream &>::type;
+template <class T>
+inline auto encode(char *s, const T &x) ->
+    typename std::enable_if<is_converted_integer<T>::value, char *>::type;
+
+// Map `x`, which is of a signed integer type, to an unsigned value of the same
+// width as `to_zigzag` does and then encode it as the overloads above do; see
+// zigzag.h.  A value of small magnitude is in the 0th class whether it is
+// negative or not.  Decode it with `decode_zigzag`.
+template <class T>
+inline auto encode_zigzag(std::ostream &os, const T &x) ->
+    typename std::enable_if<std::is_signed<T>::value &&
+                                std::is_integral<T>::value,
+                            std::ostream &>::type;
+template <class T>
+inline auto encode_zigzag(char *s, const T &x) ->
+    typename std::enable_if<std::is_signed<T>::value &&
+                                std::is_integral<T>::value,
+                            char *>::type;
+
+// Encode the `n` values starting at `x` into the bytes starting at `s` and
+// then return a pointer to the byte after the last value.
+//
+// This is equivalent to calling the overload above `n` times, so `s` must
+// point to at least 9 * `n` writable bytes.  Which instructions are used is
+// chosen at run time; see kernel.h.
+auto encode_n(char *s, const std::uint64_t *x, const std::size_t n)
+    -> decltype(s);
+
+// Encode the `n` values starting at `x` as `encode_zigzag` does and as
+// `encode_n` encodes them.
+auto encode_n_zigzag(char *s, const std::int64_t *x, const std::size_t n)
+    -> decltype(s);
+
+// Return the number of bytes that `x` is encoded in, between 1 and 9.
+//
+// This is 1 plus the class of `x`, which is the number of `Encoder<n>`
+// maxima that `x` is greater than, so it does not branch.
+constexpr std::size_t encoded_size(const std::uint64_t x);
+
+// Return the number of bytes that the values in [first, last) are encoded in,
+// so that a buffer can be sized exactly before they are encoded.
+constexpr std::size_t encoded_size(const std::uint64_t *first,
+                                   const std::uint64_t *last);
+
+// Encode the values in [first, last) into an array of `N` bytes, where `N` is
+// at least `encoded_size(first, last)`, at compile time.  Any bytes after the
+// values are 0.
+//
+// For example, a table of constants can be embedded already encoded:
+//
+//   static constexpr std::uint64_t xs[]{0x2a, 0x1234, 0xbeef};
+//   static constexpr auto s =
+//       encode_array<encoded_size(xs, xs + 3)>(xs, xs + 3);
+template <std::size_t N>
+constexpr auto encode_array(const std::uint64_t *first,
+                            const std::uint64_t *last) -> std::array<char, N>;
+
+// Encode `x` into an array of exactly the bytes it takes at compile time.
+template <std::uint64_t x>
+constexpr auto encode_array() -> std::array<char, encoded_size(x)>;
+
 namespace {
 
 static constexpr std::uint64_t get_maximum_x(const std::size_t n,
@@ -36,10 +142,12 @@ static constexpr std::uint64_t get_maximum_x(const std::size_t n,
          1ull;
 }
 
+// Encode `x` if it is in the nth class, or else try the next class.  A value
+// is assumed to be in the mth class if it is in no lesser one.
 template <std::size_t n> class Encoder {
 public:
-  static inline auto encode(std::ostream &os, const std::uint64_t &x)
-      -> decltype(os);
+  template <std::size_t m = 8ull>
+  static inline auto encode(char *s, const std::uint64_t &x) -> decltype(s);
   static constexpr unsigned char mask = get_mask(n);
   static constexpr std::uint64_t maximum_x =
       get_maximum_x(n, Encoder<n>::mask);
@@ -48,16 +156,16 @@ public:
 
 template <> class Encoder<0ull> {
 public:
-  static inline auto encode(std::ostream &os, const std::uint64_t &x)
-      -> decltype(os);
+  template <std::size_t m = 8ull>
+  static inline auto encode(char *s, const std::uint64_t &x) -> decltype(s);
   static constexpr std::uint64_t maximum_x =
       ((static_cast<unsigned char>(~0ull) + 1ull) >> 1ull) - 1ull;
 };
 
 template <> class Encoder<7ull> {
 public:
-  static inline auto encode(std::ostream &os, const std::uint64_t &x)
-      -> decltype(os);
+  template <std::size_t m = 8ull>
+  static inline auto encode(char *s, const std::uint64_t &x) -> decltype(s);
   static constexpr unsigned char mask = get_mask(7ull);
   static constexpr std::uint64_t maximum_x =
       get_maximum_x(7ull, Encoder<7ull>::mask);
@@ -65,11 +173,146 @@ public:
 
 template <> class Encoder<8ull> {
 public:
-  static inline auto encode(std::ostream &os, const std::uint64_t &x)
-      -> decltype(os);
+  template <std::size_t m = 8ull>
+  static inline auto encode(char *s, const std::uint64_t &x) -> decltype(s);
   static constexpr unsigned char mask = static_cast<unsigned char>(~0ull);
 };
 
+// The class of each possible number of significant bits in a value, that is,
+// the least n such that `Encoder<n>::maximum_x` is no less than any value with
+// that many significant bits.
+class BitLengthTable {
+public:
+  constexpr BitLengthTable() : n{} {
+    for (std::size_t bit_length{0ull}; bit_length != 65ull; ++bit_length) {
+      const std::uint64_t x{bit_length == 64ull
+                                ? ~0ull
+                                : (1ull << bit_length) - 1ull};
+      std::size_t class_{0ull};
+
+      while (class_ != 8ull && x > get_class_maximum_x(class_))
+        ++class_;
+
+      n[bit_length] = class_;
+    }
+  }
+
+  unsigned char n[65ull];
+
+private:
+  static constexpr std::uint64_t get_class_maximum_x(const std::size_t n) {
+    return n == 0ull ? 0x7full : get_maximum_x(n, get_mask(n));
+  }
+};
+
+static constexpr BitLengthTable bit_length_table{};
+}
+
+constexpr std::size_t encoded_size(const std::uint64_t x) {
+  return 1ull + (x > Encoder<0ull>::maximum_x) +
+         (x > Encoder<1ull>::maximum_x) + (x > Encoder<2ull>::maximum_x) +
+         (x > Encoder<3ull>::maximum_x) + (x > Encoder<4ull>::maximum_x) +
+         (x > Encoder<5ull>::maximum_x) + (x > Encoder<6ull>::maximum_x) +
+         (x > Encoder<7ull>::maximum_x);
+}
+
+constexpr std::size_t encoded_size(const std::uint64_t *first,
+                                   const std::uint64_t *last) {
+  std::size_t size{0ull};
+
+  for (; first != last; ++first)
+    size += encoded_size(*first);
+
+  return size;
+}
+
+template <std::size_t N>
+constexpr auto encode_array(const std::uint64_t *first,
+                            const std::uint64_t *last) -> std::array<char, N> {
+  ConstexprArray<char, N> s{};
+  std::size_t i{0ull};
+
+  for (; first != last; ++first) {
+    // The first byte of a value in the 8th class holds no bits of it.
+    const std::uint64_t x{*first};
+    const std::size_t n{encoded_size(x) - 1ull};
+    s.a[i++] = static_cast<char>(n == 8ull ? get_mask(8ull)
+                                           : get_mask(n) | x >> (8ull * n));
+
+    for (std::size_t j{n}; j != 0ull; --j)
+      s.a[i++] = static_cast<char>(x >> (8ull * (j - 1ull)) & 0xffull);
+  }
+
+  return s.to_array();
+}
+
+template <std::uint64_t x>
+constexpr auto encode_array() -> std::array<char, encoded_size(x)> {
+  const std::uint64_t y{x};
+  return encode_array<encoded_size(x)>(&y, &y + 1);
+}
+
+template <class T>
+auto encode(std::ostream &os, const T &x) ->
+    typename std::enable_if<is_converted_integer<T>::value,
+                            std::ostream &>::type {
+  return encode(os, static_cast<std::uint64_t>(x));
+}
+
+template <class T>
+auto encode(char *s, const T &x) ->
+    typename std::enable_if<is_converted_integer<T>::value, char *>::type {
+  return encode(s, static_cast<std::uint64_t>(x));
+}
+
+template <class T>
+auto encode_zigzag(std::ostream &os, const T &x) ->
+    typename std::enable_if<std::is_signed<T>::value &&
+                                std::is_integral<T>::value,
+                            std::ostream &>::type {
+  return encode(os, to_zigzag(x));
+}
+
+template <class T>
+auto encode_zigzag(char *s, const T &x) ->
+    typename std::enable_if<std::is_signed<T>::value &&
+                                std::is_integral<T>::value,
+                            char *>::type {
+  return encode(s, to_zigzag(x));
+}
+
+namespace {
+
+// Return the number of significant bits in `x`, except that 1 is returned when
+// `x` is 0.  Both are in the 0th class.
+static inline std::size_t get_bit_length(const std::uint64_t x) {
+#if defined(__GNUC__)
+  return 64ull - __builtin_clzll(x | 1ull);
+#else
+  std::size_t bit_length{1ull};
+
+  for (std::uint64_t y{x >> 1ull}; y != 0ull; y >>= 1ull)
+    ++bit_length;
+
+  return bit_length;
+#endif
+}
+
+// Store `x` bytewise big-endian in the 8 bytes starting at `s`.
+//
+// Compilers recognize this pattern and emit a single byte swap and store.
+static inline void store_big_endian(char *s, const std::uint64_t x) {
+  auto *const u = reinterpret_cast<unsigned char *>(s);
+  u[0ull] = x >> 56ull;
+  u[1ull] = x >> 48ull;
+  u[2ull] = x >> 40ull;
+  u[3ull] = x >> 32ull;
+  u[4ull] = x >> 24ull;
+  u[5ull] = x >> 16ull;
+  u[6ull] = x >> 8ull;
+  u[7ull] = x;
+}
+
 static inline void copy_least_significant_bytes(char *s_rbegin, char *const s,
                                                 std::uint64_t x) {
   for (;;) {
@@ -0,0 +1,156 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "encode_writer.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#include <unistd.h>
+
+namespace lttoolbox {
+
+EncodeWriter::EncodeWriter(std::ostream &os)
+    : sink{Sink::stream}, os{&os}, fd{-1}, string{nullptr}, vector{nullptr},
+      buffer(buffer_size), s_first{buffer.data()}, s{s_first},
+      s_last{s_first + buffer.size()}, good_{true} {}
+
+EncodeWriter::EncodeWriter(const int fd)
+    : sink{Sink::file_descriptor}, os{nullptr}, fd{fd}, string{nullptr},
+      vector{nullptr}, buffer(buffer_size), s_first{buffer.data()},
+      s{s_first}, s_last{s_first + buffer.size()}, good_{true} {}
+
+EncodeWriter::EncodeWriter(std::string &s)
+    : sink{Sink::string}, os{nullptr}, fd{-1}, string{&s}, vector{nullptr},
+      buffer{}, s_first{nullptr}, s{nullptr}, s_last{nullptr}, good_{true} {
+  resize(s.size());
+}
+
+EncodeWriter::EncodeWriter(std::vector<char> &s)
+    : sink{Sink::vector}, os{nullptr}, fd{-1}, string{nullptr}, vector{&s},
+      buffer{}, s_first{nullptr}, s{nullptr}, s_last{nullptr}, good_{true} {
+  resize(s.size());
+}
+
+EncodeWriter::~EncodeWriter() { flush(); }
+
+void EncodeWriter::encode_range(const std::uint64_t *first,
+                                const std::uint64_t *last) {
+  static constexpr std::size_t chunk_size{buffer_size / 9ull};
+
+  while (first != last) {
+    std::size_t n = (s_last - s) / 9;
+
+    if (n == 0ull) {
+      n = std::min<std::size_t>(last - first, chunk_size);
+      reserve(9ull * n);
+    }
+
+    n = std::min<std::size_t>(last - first, n);
+    s = encode_n(s, first, n);
+    first += n;
+  }
+}
+
+auto EncodeWriter::flush() -> bool {
+  switch (sink) {
+  case Sink::stream:
+  case Sink::file_descriptor:
+    write();
+
+    if (sink == Sink::stream && !os->flush())
+      good_ = false;
+
+    break;
+  case Sink::string:
+  case Sink::vector:
+    resize(s - s_first);
+    break;
+  }
+
+  return good_;
+}
+
+auto EncodeWriter::good() const -> bool { return good_; }
+
+void EncodeWriter::reserve(const std::size_t size) {
+  switch (sink) {
+  case Sink::stream:
+  case Sink::file_descriptor:
+    write();
+    break;
+  case Sink::string:
+  case Sink::vector: {
+    const std::size_t used = s - s_first;
+    const std::size_t capacity = s_last - s_first;
+    resize(std::max<std::size_t>(used + size, 2ull * capacity));
+    s = s_first + used;
+    break;
+  }
+  }
+}
+
+// Write the buffer to the stream or file descriptor and then empty it.
+void EncodeWriter::write() {
+  const std::size_t size = s - s_first;
+  s = s_first;
+
+  if (!good_)
+    return;
+
+  if (sink == Sink::stream) {
+    if (!os->write(s_first, size))
+      good_ = false;
+
+    return;
+  }
+
+  for (const char *first{s_first}, *const last{first + size};
+       first != last;) {
+    const auto written = ::write(fd, first, last - first);
+
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+
+      good_ = false;
+      return;
+    }
+
+    first += written;
+  }
+}
+
+// Resize the container to `size` bytes and point `s_first` and `s_last` to the
+// beginning and end of it.  `s` is left pointing to the end.
+void EncodeWriter::resize(const std::size_t size) {
+  if (sink == Sink::string)
+    string->resize(size);
+  else
+    vector->resize(size);
+
+  s_first = get_container_data();
+  s = s_first + size;
+  s_last = s;
+}
+
+auto EncodeWriter::get_container_data() -> char * {
+  return sink == Sink::string ? &(*string)[0ull] : vector->data();
+}
+
+EncodeOutputIterator::EncodeOutputIterator(EncodeWriter &writer)
+    : writer{&writer} {}
+
+} // end namespace lttoolbox
@@ -0,0 +1,134 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_ENCODE_WRITER_H
+#define APERTIUM_LTTOOLBOX_ENCODE_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "encode.h"
+
+namespace lttoolbox {
+
+// Encode values in Apertium binary format into a buffer and write the buffer
+// to a `std::ostream` or a file descriptor only when it is full, when
+// `flush` is called, or when the writer is destroyed.
+//
+// Writing to a `std::string` or a `std::vector<char>`, the writer instead
+// encodes straight into the container, growing it geometrically.  The
+// container then holds some unspecified bytes after the values until `flush`
+// is called or the writer is destroyed, when it is shrunk to fit them.  Any
+// bytes already in the container are kept, and the values are appended.
+//
+// An `EncodeWriter` must not outlive what it writes to, and nothing else
+// should write to that until the writer is flushed.
+class EncodeWriter {
+public:
+  static constexpr std::size_t buffer_size{1ull << 16ull};
+
+  explicit EncodeWriter(std::ostream &os);
+  explicit EncodeWriter(const int fd);
+  explicit EncodeWriter(std::string &s);
+  explicit EncodeWriter(std::vector<char> &s);
+  EncodeWriter(const EncodeWriter &) = delete;
+  auto operator=(const EncodeWriter &) -> EncodeWriter & = delete;
+  ~EncodeWriter();
+
+  inline void encode(const std::uint64_t x);
+  void encode_range(const std::uint64_t *first, const std::uint64_t *last);
+
+  // Write everything encoded so far, or, for a container, shrink it to fit,
+  // and then return whether every write so far succeeded.
+  auto flush() -> bool;
+
+  // Return whether every write so far succeeded.
+  auto good() const -> bool;
+
+private:
+  enum class Sink { stream, file_descriptor, string, vector };
+
+  // Make at least `size` bytes available after `s`.
+  void reserve(const std::size_t size);
+  void write();
+  void resize(const std::size_t size);
+  auto get_container_data() -> char *;
+
+  Sink sink;
+  std::ostream *os;
+  int fd;
+  std::string *string;
+  std::vector<char> *vector;
+  std::vector<char> buffer;
+  char *s_first;
+  char *s;
+  char *s_last;
+  bool good_;
+};
+
+// An output iterator that encodes each value assigned through it with an
+// `EncodeWriter`, so that standard algorithms can write to any of its sinks.
+class EncodeOutputIterator {
+public:
+  using iterator_category = std::output_iterator_tag;
+  using value_type = void;
+  using difference_type = void;
+  using pointer = void;
+  using reference = void;
+
+  explicit EncodeOutputIterator(EncodeWriter &writer);
+
+  inline auto operator=(const std::uint64_t x) -> EncodeOutputIterator &;
+  inline auto operator*() -> EncodeOutputIterator &;
+  inline auto operator++() -> EncodeOutputIterator &;
+  inline auto operator++(int) -> EncodeOutputIterator &;
+
+private:
+  EncodeWriter *writer;
+};
+
+void EncodeWriter::encode(const std::uint64_t x) {
+  if (s_last - s < 9)
+    reserve(9ull);
+
+  s = lttoolbox::encode(s, x);
+}
+
+auto EncodeOutputIterator::operator=(const std::uint64_t x)
+    -> EncodeOutputIterator & {
+  writer->encode(x);
+  return *this;
+}
+
+auto EncodeOutputIterator::operator*() -> EncodeOutputIterator & {
+  return *this;
+}
+
+auto EncodeOutputIterator::operator++() -> EncodeOutputIterator & {
+  return *this;
+}
+
+auto EncodeOutputIterator::operator++(int) -> EncodeOutputIterator & {
+  return *this;
+}
+
+} // end namespace lttoolbox
+
+#endif
@@ -0,0 +1,77 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_FLOAT_BITS_H
+#define APERTIUM_LTTOOLBOX_FLOAT_BITS_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace lttoolbox {
+
+// Rotate the second least significant byte of `x` left by `r` bits.
+template <unsigned int r, class U>
+inline auto rotate_second_byte(const U x) -> U {
+  const U b{static_cast<U>((x >> 8u) & 0xffu)};
+  const U rotated{static_cast<U>(((b << r) | (b >> (8u - r))) & 0xffu)};
+  return static_cast<U>((x & ~static_cast<U>(0xff00u)) | rotated << 8u);
+}
+
+// Return the unsigned value that `x` is encoded as.
+//
+// The bytes of the bit pattern of `x` are reversed, so that the least
+// significant bytes of the mantissa, which are zero for a short mantissa,
+// become leading zeros.  The least significant byte then holds the sign and
+// the 7 most significant bits of the exponent, and the next byte holds the
+// rest of the exponent and the most significant bits of the mantissa.  That
+// byte is rotated so that the rest of the exponent is next to the 7 bits.
+// Thus 0.0 and 2.0 are in the 0th class, and 1.0, -1.0, 0.5 and 4.0 are in
+// the 1st class, rather than the 8th class for a `double` or the 4th for a
+// `float`.  The mapping is only a
+// permutation of the bits, so every value, including negative zero and any
+// NaN, is encoded exactly.
+inline auto to_float_bits(const double x) -> std::uint64_t {
+  std::uint64_t u{0ull};
+  std::memcpy(&u, &x, sizeof(u));
+  return rotate_second_byte<4u>(
+      static_cast<std::uint64_t>(__builtin_bswap64(u)));
+}
+
+inline auto to_float_bits(const float x) -> std::uint32_t {
+  std::uint32_t u{0u};
+  std::memcpy(&u, &x, sizeof(u));
+  return rotate_second_byte<1u>(
+      static_cast<std::uint32_t>(__builtin_bswap32(u)));
+}
+
+// Return the value that is encoded as `x`.  This is the inverse of
+// `to_float_bits`.
+inline auto from_float_bits(const std::uint64_t x) -> double {
+  const std::uint64_t u{__builtin_bswap64(rotate_second_byte<4u>(x))};
+  double y{0.0};
+  std::memcpy(&y, &u, sizeof(y));
+  return y;
+}
+
+inline auto from_float_bits(const std::uint32_t x) -> float {
+  const std::uint32_t u{__builtin_bswap32(rotate_second_byte<7u>(x))};
+  float y{0.0f};
+  std::memcpy(&y, &u, sizeof(y));
+  return y;
+}
+
+} // end namespace lttoolbox
+
+#endif
@@ -0,0 +1,308 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "group_varint.h"
+#include "decode.h"
+#include "decode_iterator.h"
+#include "encode.h"
+#include "encode_writer.h"
+#include "kernel.h"
+
+namespace lttoolbox {
+
+namespace {
+
+// Return the code of `x`, the base-2 logarithm of the number of bytes that it
+// is written in.
+static inline auto get_code(const std::uint64_t x) -> unsigned int;
+
+// For each control byte, the number of bytes of its 4 values, and, for each
+// code, the mask of the bytes of a value with it.
+class ControlTable {
+public:
+  constexpr ControlTable() : size{}, mask{} {
+    for (std::size_t c{0ull}; c != 256ull; ++c)
+      for (std::size_t i{0ull}; i != 4ull; ++i)
+        size[c] += 1u << (c >> (2ull * i) & 3ull);
+
+    for (std::size_t code{0ull}; code != 4ull; ++code)
+      mask[code] = code == 3ull ? ~0ull : (1ull << (8ull << code)) - 1ull;
+  }
+
+  unsigned char size[256ull];
+  std::uint64_t mask[4ull];
+};
+
+static constexpr ControlTable control_table{};
+
+// Set `size` to the number of bytes of the `n` values whose codes are in the
+// control bytes starting at `controls`, and then return whether the unused
+// codes in the last control byte are 0.  The bytes of each 4 values are
+// looked up by their control byte.
+static auto get_payload_size(const unsigned char *controls,
+                             const std::size_t n, std::size_t &size) -> bool;
+
+// Decode the `n` values whose codes are in the control bytes starting at
+// `controls` and whose bytes are in [s, last) into the `n` elements starting
+// at `x`.  [s, last) must hold all of their bytes.
+static void decode_payload_scalar(const unsigned char *controls,
+                                  const char *s, const char *last,
+                                  std::uint64_t *x, const std::size_t n);
+
+#if HAVE_X86_SIMD
+
+__attribute__((target("ssse3,sse4.1"))) static void
+decode_payload_sse41(const unsigned char *controls, const char *s,
+                     const char *last, std::uint64_t *x, const std::size_t n);
+
+#endif
+
+// The implementation of decoding the bytes of a group block for each
+// `Kernel`.
+static void (*const decode_payload_kernels[kernel_count])(
+    const unsigned char *controls, const char *s, const char *last,
+    std::uint64_t *x, const std::size_t n){
+    decode_payload_scalar,
+
+#if HAVE_X86_SIMD
+
+    decode_payload_sse41, decode_payload_sse41, decode_payload_scalar
+
+#else
+
+    decode_payload_scalar, decode_payload_scalar, decode_payload_scalar
+
+#endif
+};
+
+// Decode the `n` values of a group block whose control bytes start at
+// `controls` and whose bytes are in [s, last) into the `n` elements starting
+// at `x`.
+static inline void decode_payload(const unsigned char *controls,
+                                  const char *s, const char *last,
+                                  std::uint64_t *x, const std::size_t n) {
+  decode_payload_kernels[static_cast<std::size_t>(
+      get_kernel(Operation::decode))](controls, s, last, x, n);
+}
+}
+
+auto encode_group(char *s, const std::uint64_t *x, const std::size_t n)
+    -> decltype(s) {
+  s = encode(s, std::uint64_t{n});
+  auto *const controls = reinterpret_cast<unsigned char *>(s);
+  s += (n + 3ull) / 4ull;
+
+  for (std::size_t i{0ull}; i != n; ++i) {
+    const unsigned int code{get_code(x[i])};
+
+    if (i % 4ull == 0ull)
+      controls[i / 4ull] = 0u;
+
+    controls[i / 4ull] |= code << (2ull * (i % 4ull));
+
+    // Write all 8 bytes and then keep only as many as the code says.
+    for (std::size_t j{0ull}; j != 8ull; ++j)
+      s[j] = static_cast<char>(x[i] >> (8ull * j));
+
+    s += 1ull << code;
+  }
+
+  return s;
+}
+
+auto decode_group(const char *first, const char *last,
+                  std::vector<std::uint64_t> &xs) -> decltype(first) {
+  std::uint64_t n{0ull};
+  const char *s{decode_count(first, last, n)};
+
+  if (s == first)
+    return first;
+
+  const auto *const controls = reinterpret_cast<const unsigned char *>(s);
+  s += (n + 3ull) / 4ull;
+
+  if (s > last)
+    return first;
+
+  std::size_t size{0ull};
+
+  if (!get_payload_size(controls, n, size) ||
+      size > static_cast<std::size_t>(last - s))
+    return first;
+
+  const std::size_t offset{xs.size()};
+  xs.resize(offset + n);
+  decode_payload(controls, s, s + size, xs.data() + offset, n);
+  return s + size;
+}
+
+auto transcode_to_group(std::istream &is, std::ostream &os) -> bool {
+  DecodedRange range{is};
+  std::vector<std::uint64_t> x{};
+  x.reserve(group_block_size);
+  std::vector<char> s(get_group_capacity(group_block_size));
+
+  const auto write = [&]() {
+    os.write(s.data(), encode_group(s.data(), x.data(), x.size()) - s.data());
+    x.clear();
+  };
+
+  for (auto it = range.begin(); it != range.end(); ++it) {
+    x.push_back(*it);
+
+    if (x.size() == group_block_size)
+      write();
+  }
+
+  if (!x.empty())
+    write();
+
+  return range.good() && os.flush();
+}
+
+auto transcode_from_group(std::istream &is, std::ostream &os) -> bool {
+  std::vector<unsigned char> controls((group_block_size + 3ull) / 4ull);
+  std::vector<char> s(8ull * group_block_size);
+  std::vector<std::uint64_t> x(group_block_size);
+  EncodeWriter writer{os};
+
+  while (is.peek() != std::istream::traits_type::eof()) {
+    std::uint64_t n{0ull};
+
+    if (!decode(is, n) || n > group_block_size)
+      return false;
+
+    const std::size_t control_size = (n + 3ull) / 4ull;
+
+    if (!is.read(reinterpret_cast<char *>(controls.data()), control_size))
+      return false;
+
+    std::size_t size{0ull};
+
+    if (!get_payload_size(controls.data(), n, size) ||
+        !is.read(s.data(), size))
+      return false;
+
+    decode_payload(controls.data(), s.data(), s.data() + size, x.data(), n);
+    writer.encode_range(x.data(), x.data() + n);
+  }
+
+  return writer.flush();
+}
+
+namespace {
+
+auto get_code(const std::uint64_t x) -> unsigned int {
+  return (x > 0xffull) + (x > 0xff'ffull) + (x > 0xff'ff'ff'ffull);
+}
+
+auto get_payload_size(const unsigned char *controls, const std::size_t n,
+                      std::size_t &size) -> bool {
+  size = 0ull;
+  const unsigned char *const full_last{controls + n / 4ull};
+
+  for (; controls != full_last; ++controls)
+    size += control_table.size[*controls];
+
+  if (n % 4ull == 0ull)
+    return true;
+
+  if (*controls >> (2ull * (n % 4ull)) != 0u)
+    return false;
+
+  // Each of the unused codes is 0, so it adds 1 byte to the size.
+  size += control_table.size[*controls] - (4ull - n % 4ull);
+  return true;
+}
+
+void decode_payload_scalar(const unsigned char *controls, const char *s,
+                           const char *last, std::uint64_t *x,
+                           const std::size_t n) {
+  for (std::size_t i{0ull}; i != n; ++i) {
+    const unsigned int code{controls[i / 4ull] >> (2ull * (i % 4ull)) & 3u};
+    const std::size_t size{1ull << code};
+
+    // Load 8 bytes unless fewer remain, and then keep only the value's.
+    if (last - s >= 8) {
+      x[i] = load_little_endian(s) & control_table.mask[code];
+    } else {
+      x[i] = 0ull;
+
+      for (std::size_t j{0ull}; j != size; ++j)
+        x[i] |= static_cast<std::uint64_t>(static_cast<unsigned char>(s[j]))
+                << (8ull * j);
+    }
+
+    s += size;
+  }
+}
+}
+
+#if HAVE_X86_SIMD
+
+namespace {
+
+// For each 4 bits of codes of 2 values, the shuffle that moves each value
+// into its own little-endian 64-bit lane, and the number of bytes that they
+// take.
+class PairTable {
+public:
+  constexpr PairTable() : shuffle{}, size{} {
+    for (std::size_t h{0ull}; h != 16ull; ++h) {
+      const std::size_t a{1ull << (h & 3ull)};
+      const std::size_t b{1ull << (h >> 2ull)};
+
+      for (std::size_t j{0ull}; j != 8ull; ++j) {
+        shuffle[h][j] = j < a ? j : 0x80u;
+        shuffle[h][8ull + j] = j < b ? a + j : 0x80u;
+      }
+
+      size[h] = a + b;
+    }
+  }
+
+  unsigned char shuffle[16ull][16ull];
+  unsigned char size[16ull];
+};
+
+static constexpr PairTable pair_table{};
+
+void decode_payload_sse41(const unsigned char *controls, const char *s,
+                          const char *last, std::uint64_t *x,
+                          const std::size_t n) {
+  std::size_t i{0ull};
+
+  // 4 values take at most 32 bytes, so both 16-byte loads are in bounds.
+  for (; n - i >= 4ull && last - s >= 32; i += 4ull) {
+    const unsigned int c{controls[i / 4ull]};
+
+    for (const unsigned int h : {c & 0xfu, c >> 4u}) {
+      const __m128i v{_mm_loadu_si128(reinterpret_cast<const __m128i *>(s))};
+      const __m128i shuffle{_mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(pair_table.shuffle[h]))};
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(x),
+                       _mm_shuffle_epi8(v, shuffle));
+      s += pair_table.size[h];
+      x += 2;
+    }
+  }
+
+  decode_payload_scalar(controls + i / 4ull, s, last, x, n - i);
+}
+}
+
+#endif
+
+} // end namespace lttoolbox
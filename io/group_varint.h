@@ -0,0 +1,80 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_GROUP_VARINT_H
+#define APERTIUM_LTTOOLBOX_GROUP_VARINT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace lttoolbox {
+
+// The number of values in each block that `transcode_to_group` writes, which
+// is also the greatest number that `transcode_from_group` accepts.
+static constexpr std::size_t group_block_size{1ull << 12ull};
+
+// Encode the `n` values starting at `x` as a group block and then return a
+// pointer to the byte after it.
+//
+// A group block is an alternative layout for bulk arrays of values, in which
+// the lengths of the values are separated from their bytes.  It is the number
+// of values, encoded in Apertium binary format, then a control byte for each 4
+// values, and then the bytes of the values.  Each 2 bits of a control byte,
+// from the least significant, are the code of a value, which is written
+// little-endian in 1, 2, 4, or 8 bytes for a code of 0, 1, 2, or 3,
+// respectively.  Unused codes in the last control byte are 0.  Because the
+// lengths of 4 values are known before any of their bytes are read, a decoder
+// can move 2 values at a time with one shuffle looked up by their 4 bits of
+// codes.  `s` must point to at least `get_group_capacity(n)` writable bytes.
+auto encode_group(char *s, const std::uint64_t *x, const std::size_t n)
+    -> decltype(s);
+
+// Return the greatest number of bytes that `encode_group` writes.
+constexpr std::size_t get_group_capacity(const std::size_t n) {
+  return 9ull + (n + 3ull) / 4ull + 8ull * n;
+}
+
+// Decode a group block encoded by `encode_group` from the bytes in [first,
+// last), append its values to `xs`, and then return a pointer to the byte
+// after it.
+//
+// Which instructions are used is chosen at run time; see kernel.h.  If
+// [first, last) does not hold a whole block, or an unused code in its last
+// control byte is not 0, this function returns `first` and leaves `xs` as it
+// was.
+auto decode_group(const char *first, const char *last,
+                  std::vector<std::uint64_t> &xs) -> decltype(first);
+
+// Read values encoded in Apertium binary format from `is` to its end, write
+// them to `os` as group blocks of `group_block_size` values, and then return
+// whether the last value was whole and every write succeeded.
+//
+// The values are read and written a block at a time, so the memory used does
+// not depend on the number of values.
+auto transcode_to_group(std::istream &is, std::ostream &os) -> bool;
+
+// Read group blocks from `is` to its end, write their values to `os` encoded
+// in Apertium binary format, and then return whether every block was whole,
+// held at most `group_block_size` values, had no unused codes other than 0,
+// and was written successfully.
+auto transcode_from_group(std::istream &is, std::ostream &os) -> bool;
+
+} // end namespace lttoolbox
+
+#endif
@@ -0,0 +1,122 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "kernel.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+namespace lttoolbox {
+
+namespace {
+
+static auto get_kernel_(const Operation operation) -> std::atomic<Kernel> &;
+static auto detect(const Operation operation) -> Kernel;
+
+static constexpr const char *names[kernel_count]{"scalar", "sse4.1", "avx2",
+                                                 "bmi2"};
+
+// For each `Operation`, the kernels from fastest to slowest, as measured by
+// benchio on mixed data and on symbols.  Decoding with BMI2 is slower than
+// the scalar kernel, since LZCNT is no faster than the class table, and
+// encoding with BMI2 is the fastest, since the vector kernels encode value by
+// value too.
+static constexpr Kernel rankings[operation_count][kernel_count]{
+    {Kernel::avx2, Kernel::sse41, Kernel::scalar, Kernel::bmi2},
+    {Kernel::bmi2, Kernel::avx2, Kernel::sse41, Kernel::scalar}};
+}
+
+auto get_kernel(const Operation operation) -> Kernel {
+  return get_kernel_(operation).load(std::memory_order_relaxed);
+}
+
+auto set_kernel(const Kernel kernel) -> bool {
+  if (!is_supported(kernel))
+    return false;
+
+  for (std::size_t i{0ull}; i != operation_count; ++i)
+    get_kernel_(static_cast<Operation>(i))
+        .store(kernel, std::memory_order_relaxed);
+
+  return true;
+}
+
+auto set_kernel(const Operation operation, const Kernel kernel) -> bool {
+  if (!is_supported(kernel))
+    return false;
+
+  get_kernel_(operation).store(kernel, std::memory_order_relaxed);
+  return true;
+}
+
+auto is_supported(const Kernel kernel) -> bool {
+  switch (kernel) {
+  case Kernel::scalar:
+    return true;
+
+#if HAVE_X86_SIMD
+
+  case Kernel::sse41:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1");
+  case Kernel::avx2:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+  case Kernel::bmi2:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi") && __builtin_cpu_supports("bmi2") &&
+           __builtin_cpu_supports("lzcnt");
+
+#endif
+
+  default:
+    return false;
+  }
+}
+
+auto get_name(const Kernel kernel) -> const char * {
+  return names[static_cast<std::size_t>(kernel)];
+}
+
+namespace {
+
+auto get_kernel_(const Operation operation) -> std::atomic<Kernel> & {
+  static std::atomic<Kernel> kernels[operation_count]{
+      {detect(Operation::decode)}, {detect(Operation::encode)}};
+  return kernels[static_cast<std::size_t>(operation)];
+}
+
+// Return the implementation named by LTTOOLBOX_IO_KERNEL, if the CPU supports
+// it, or else the fastest one for `operation` that the CPU supports.
+auto detect(const Operation operation) -> Kernel {
+  if (const char *const name = std::getenv("LTTOOLBOX_IO_KERNEL")) {
+    for (std::size_t i{0ull}; i != kernel_count; ++i) {
+      const auto kernel = static_cast<Kernel>(i);
+
+      if (std::strcmp(name, names[i]) == 0 && is_supported(kernel))
+        return kernel;
+    }
+  }
+
+  for (const auto kernel : rankings[static_cast<std::size_t>(operation)])
+    if (is_supported(kernel))
+      return kernel;
+
+  return Kernel::scalar;
+}
+}
+
+} // end namespace lttoolbox
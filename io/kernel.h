@@ -0,0 +1,91 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_KERNEL_H
+#define APERTIUM_LTTOOLBOX_KERNEL_H
+
+#include <cstddef>
+
+// Whether the SSE4.1, AVX2 and BMI2 kernels are compiled, which needs GCC or
+// Clang for `__attribute__((target))` and `__builtin_cpu_supports`.  If not,
+// each of them falls back to the scalar kernel.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+
+#else
+
+#define HAVE_X86_SIMD 0
+
+#endif
+
+namespace lttoolbox {
+
+// An implementation of the bulk functions `decode_n` and `encode_n`.
+//
+// Each implementation decodes and encodes exactly the same values; they
+// differ only in which instructions they use.  All of them are compiled into
+// the library, whatever the compiler flags, and the first time one is needed,
+// the fastest one that the CPU supports is chosen for each `Operation`, since
+// which is fastest differs between decoding and encoding.  Setting the
+// environment variable LTTOOLBOX_IO_KERNEL to the name of an implementation,
+// for example "scalar", chooses that one for every operation instead, if the
+// CPU supports it.
+enum class Kernel : unsigned char {
+  // Portable C++.
+  scalar,
+  // SSSE3 and SSE4.1 shuffles of 16 bytes at a time.
+  sse41,
+  // AVX2, which handles runs of values in the 0th class 32 at a time.
+  // Encoding with this or the SSE4.1 kernel is branchless but not vectorised.
+  avx2,
+  // Portable C++ compiled with BMI2 shifts and LZCNT, which finds the class
+  // without a table.
+  bmi2
+};
+
+static constexpr std::size_t kernel_count{4ull};
+
+// A group of bulk functions that always use the same `Kernel`.
+enum class Operation : unsigned char {
+  // `decode_n`, `count_values`, `validate`, and the decoders built on them.
+  decode,
+  // `encode_n` and the encoders built on it.
+  encode
+};
+
+static constexpr std::size_t operation_count{2ull};
+
+// Return the implementation that `operation` uses.
+auto get_kernel(const Operation operation) -> Kernel;
+
+// Make every operation use `kernel` and then return true, or, if the CPU does
+// not support `kernel`, return false.
+auto set_kernel(const Kernel kernel) -> bool;
+
+// Make `operation` use `kernel` and then return true, or, if the CPU does not
+// support `kernel`, return false.
+auto set_kernel(const Operation operation, const Kernel kernel) -> bool;
+
+auto is_supported(const Kernel kernel) -> bool;
+
+// Return the name of `kernel`, which is also the value of LTTOOLBOX_IO_KERNEL
+// that chooses it.
+auto get_name(const Kernel kernel) -> const char *;
+
+} // end namespace lttoolbox
+
+#endif
@@ -0,0 +1,124 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "mapped_decoder.h"
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lttoolbox {
+
+MappedDecoder::MappedDecoder(const char *path)
+    : first{nullptr}, s{nullptr}, last{nullptr}, is_open_{false} {
+  const int fd{::open(path, O_RDONLY | O_CLOEXEC)};
+
+  if (fd == -1)
+    return;
+
+  struct stat status;
+
+  if (::fstat(fd, &status) == -1) {
+    const int error{errno};
+    ::close(fd);
+    errno = error;
+    return;
+  }
+
+  const std::size_t size = status.st_size;
+
+  // An empty file cannot be mapped, but it holds no values anyway.
+  if (size == 0ull) {
+    ::close(fd);
+    is_open_ = true;
+    return;
+  }
+
+  void *const p{::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0)};
+  const int error{errno};
+
+  // The mapping keeps the file open.
+  ::close(fd);
+
+  if (p == MAP_FAILED) {
+    errno = error;
+    return;
+  }
+
+  ::madvise(p, size, MADV_SEQUENTIAL);
+  ::madvise(p, size, MADV_WILLNEED);
+  first = static_cast<const char *>(p);
+  s = first;
+  last = first + size;
+  is_open_ = true;
+}
+
+MappedDecoder::MappedDecoder(MappedDecoder &&other)
+    : first{other.first}, s{other.s}, last{other.last},
+      is_open_{other.is_open_} {
+  other.first = nullptr;
+  other.s = nullptr;
+  other.last = nullptr;
+  other.is_open_ = false;
+}
+
+MappedDecoder::~MappedDecoder() {
+  if (first != nullptr)
+    ::munmap(const_cast<char *>(first), last - first);
+}
+
+auto MappedDecoder::is_open() const -> bool { return is_open_; }
+
+auto MappedDecoder::begin() const -> const char * { return first; }
+
+auto MappedDecoder::end() const -> const char * { return last; }
+
+auto MappedDecoder::size() const -> std::size_t { return last - first; }
+
+auto MappedDecoder::tell() const -> std::size_t { return s - first; }
+
+auto MappedDecoder::seek(const std::size_t offset) -> bool {
+  if (offset > size())
+    return false;
+
+  s = first + offset;
+  return true;
+}
+
+auto MappedDecoder::seek_to_value(const BlockIndex &index, const std::size_t k)
+    -> bool {
+  const char *const next{lttoolbox::seek_to_value(first, last, index, k)};
+
+  if (next == nullptr)
+    return false;
+
+  s = next;
+  return true;
+}
+
+auto MappedDecoder::decode_n(std::uint64_t *x, const std::size_t n) -> bool {
+  const char *const next{lttoolbox::decode_n(s, last, x, n)};
+
+  if (next == s && n != 0ull)
+    return false;
+
+  s = next;
+  return true;
+}
+
+} // end namespace lttoolbox
@@ -0,0 +1,91 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_MAPPED_DECODER_H
+#define APERTIUM_LTTOOLBOX_MAPPED_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "block_index.h"
+#include "decode.h"
+
+namespace lttoolbox {
+
+// Map a file of values encoded in Apertium binary format into memory
+// read-only and decode them in place.
+//
+// Every process that maps the same file shares its pages in the page cache,
+// and no byte is copied before it is decoded.  The mapping is advised to be
+// read sequentially and soon, so the kernel reads ahead aggressively.
+//
+// If the file cannot be opened or mapped, `is_open` returns false, errno is
+// left as the failing call set it, and the byte range is empty.
+class MappedDecoder {
+public:
+  explicit MappedDecoder(const char *path);
+  MappedDecoder(MappedDecoder &&other);
+  MappedDecoder(const MappedDecoder &) = delete;
+  auto operator=(const MappedDecoder &) -> MappedDecoder & = delete;
+  ~MappedDecoder();
+
+  auto is_open() const -> bool;
+
+  // The whole file.
+  auto begin() const -> const char *;
+  auto end() const -> const char *;
+  auto size() const -> std::size_t;
+
+  // The position of the next value to decode.
+  auto tell() const -> std::size_t;
+
+  // Seek to `offset` and then return true, or, if it is past the end of the
+  // file, return false and leave the position as it was.
+  auto seek(const std::size_t offset) -> bool;
+
+  // Seek to the kth value with `index`, which indexes the whole file, and
+  // then return true, or, if there is no kth value, return false and leave the
+  // position as it was.  See `seek_to_value` in block_index.h.
+  auto seek_to_value(const BlockIndex &index, const std::size_t k) -> bool;
+
+  // Decode the next value into `x` and then return true, or, if there is no
+  // whole value left, return false and leave the position as it was.
+  inline auto decode(std::uint64_t &x) -> bool;
+
+  // Decode the next `n` values into the `n` elements starting at `x` as
+  // `decode_n` does and then return true, or, if there are not `n` whole
+  // values left, return false and leave the position as it was.
+  auto decode_n(std::uint64_t *x, const std::size_t n) -> bool;
+
+private:
+  const char *first;
+  const char *s;
+  const char *last;
+  bool is_open_;
+};
+
+auto MappedDecoder::decode(std::uint64_t &x) -> bool {
+  const char *const next{lttoolbox::decode(s, last, x)};
+
+  if (next == s)
+    return false;
+
+  s = next;
+  return true;
+}
+
+} // end namespace lttoolbox
+
+#endif
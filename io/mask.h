@@ -17,6 +17,11 @@
 #define APERTIUM_LTTOOLBOX_MASK_H
 
 #include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <type_traits>
+#include <utility>
 
 namespace lttoolbox {
 
@@ -24,6 +29,66 @@ constexpr unsigned char get_mask(const std::size_t n) {
   return ~static_cast<unsigned char>((1ull << (8ull - n)) - 1ull);
 }
 
+// Return the class of a value from the first byte of its encoding, which is
+// the number of leading ones in that byte.
+constexpr std::size_t get_class(const unsigned char c) {
+  std::size_t n{0ull};
+
+  while (n != 8ull && (c & get_mask(n + 1ull)) == get_mask(n + 1ull))
+    ++n;
+
+  return n;
+}
+
+// Return the greatest class that a value with `bit_length` significant bits
+// can be in.
+//
+// A value in the nth class, for n between 0 and 7 (inclusive), has 7 * n + 7
+// literal bits, and a value in the 8th class has 64.
+constexpr std::size_t get_maximum_class(const std::size_t bit_length) {
+  std::size_t n{0ull};
+
+  while (n != 8ull && 7ull * n + 7ull < bit_length)
+    ++n;
+
+  return n;
+}
+
+// Whether there are `encode` and `decode` overloads specialised for the width
+// of `T`, which is narrower than that of `std::uint64_t`.
+template <class T> struct is_narrow : std::false_type {};
+template <> struct is_narrow<std::uint8_t> : std::true_type {};
+template <> struct is_narrow<std::uint16_t> : std::true_type {};
+template <> struct is_narrow<std::uint32_t> : std::true_type {};
+
+// Whether `T` is an integer type with no `encode` overload of its own, such as
+// `int` or `unsigned long long`, and so is converted to `std::uint64_t`.
+template <class T>
+struct is_converted_integer
+    : std::integral_constant<
+          bool, std::is_integral<T>::value && !is_narrow<T>::value &&
+                    !std::is_same<T, std::uint64_t>::value> {};
+
+// An array that, unlike `std::array` before C++17, can be written to in a
+// constexpr function and then converted to a `std::array`.
+template <class T, std::size_t N> class ConstexprArray {
+public:
+  constexpr ConstexprArray() : a{} {}
+
+  constexpr auto to_array() const -> std::array<T, N> {
+    return to_array(std::make_index_sequence<N>{});
+  }
+
+  T a[N == 0ull ? 1ull : N];
+
+private:
+  template <std::size_t... i>
+  constexpr auto to_array(std::index_sequence<i...>) const
+      -> std::array<T, N> {
+    return {{a[i]...}};
+  }
+};
+
 } // end namespace lttoolbox
 
 #endif
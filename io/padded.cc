@@ -0,0 +1,120 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "padded.h"
+#include "decode.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace lttoolbox {
+
+namespace {
+
+// Decode a value from `first`, from which at least 9 bytes must be readable,
+// into `x` and then return a pointer to the byte after the value.
+static inline auto decode_padded_unchecked(const char *first,
+                                           std::uint64_t &x)
+    -> decltype(first);
+}
+
+PaddedBuffer::PaddedBuffer() : bytes(padding) {}
+
+PaddedBuffer::PaddedBuffer(const std::size_t size) : bytes(size + padding) {}
+
+PaddedBuffer::PaddedBuffer(const char *first, const char *last)
+    : bytes(last - first + padding) {
+  std::copy(first, last, bytes.begin());
+}
+
+auto PaddedBuffer::data() -> char * { return bytes.data(); }
+
+auto PaddedBuffer::data() const -> const char * { return bytes.data(); }
+
+auto PaddedBuffer::size() const -> std::size_t {
+  return bytes.size() - padding;
+}
+
+auto PaddedBuffer::begin() const -> const char * { return bytes.data(); }
+
+auto PaddedBuffer::end() const -> const char * {
+  return bytes.data() + size();
+}
+
+void PaddedBuffer::resize(const std::size_t size) {
+  bytes.resize(size + padding);
+  std::fill(bytes.begin() + size, bytes.end(), '\0');
+}
+
+auto read_padded(std::istream &is) -> PaddedBuffer {
+  const std::vector<char> s{std::istreambuf_iterator<char>{is},
+                            std::istreambuf_iterator<char>{}};
+  return {s.data(), s.data() + s.size()};
+}
+
+auto decode_padded(const char *first, const char *last, std::uint64_t &x)
+    -> decltype(first) {
+  if (first == last)
+    return first;
+
+  std::uint64_t y{0ull};
+  const char *const s{decode_padded_unchecked(first, y)};
+
+  if (s > last)
+    return first;
+
+  x = y;
+  return s;
+}
+
+auto decode_n_padded(const char *first, const char *last, std::uint64_t *x,
+                     const std::size_t n) -> decltype(first) {
+  const char *s{first};
+
+  // A value that starts before `last` ends at most 8 bytes after it, so it is
+  // enough to check each value after decoding it.
+  for (const std::uint64_t *const x_last{x + n}; x != x_last; ++x) {
+    if (s >= last)
+      return first;
+
+    s = decode_padded_unchecked(s, *x);
+  }
+
+  return s > last ? first : s;
+}
+
+auto decode_n_padded(const PaddedBuffer &s, std::uint64_t *x,
+                     const std::size_t n) -> const char * {
+  return decode_n_padded(s.begin(), s.end(), x, n);
+}
+
+namespace {
+
+auto decode_padded_unchecked(const char *first, std::uint64_t &x)
+    -> decltype(first) {
+  // For the 0th to 7th classes, the whole value is in the first n + 1 bytes
+  // of `s`, and its 7 * n + 7 least significant bits are literal.  For the
+  // 8th class, the 8 bytes after the first byte are the value.  Both are
+  // computed, and the shift is masked, so that no branch depends on n.
+  const std::uint64_t s{load_big_endian(first)};
+  const std::size_t n{class_table.n[s >> 56ull]};
+  const std::uint64_t y{s >> ((56ull - 8ull * n) & 63ull) &
+                        ((1ull << (7ull * n + 7ull)) - 1ull)};
+  x = n == 8ull ? load_big_endian(first + 1ull) : y;
+  return first + 1ull + n;
+}
+}
+
+} // end namespace lttoolbox
@@ -0,0 +1,75 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_PADDED_H
+#define APERTIUM_LTTOOLBOX_PADDED_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <istream>
+#include <vector>
+
+namespace lttoolbox {
+
+// A buffer of bytes that is followed by at least `padding` more readable
+// bytes, all equal to zero.
+//
+// The padding lets `decode_padded` and `decode_n_padded` load 8 bytes at once
+// wherever a value starts, even if the value is one of the last in the
+// buffer.
+class PaddedBuffer {
+public:
+  static constexpr std::size_t padding{8ull};
+
+  PaddedBuffer();
+  explicit PaddedBuffer(const std::size_t size);
+  PaddedBuffer(const char *first, const char *last);
+
+  auto data() -> char *;
+  auto data() const -> const char *;
+  auto size() const -> std::size_t;
+  auto begin() const -> const char *;
+  auto end() const -> const char *;
+
+  // Change the size of the buffer to `size`, keeping the first `size` bytes
+  // and setting any new bytes to zero.
+  void resize(const std::size_t size);
+
+private:
+  std::vector<char> bytes;
+};
+
+// Read everything that remains in `is` into a padded buffer.
+auto read_padded(std::istream &is) -> PaddedBuffer;
+
+// Decode a value as `decode` does, but with only one 8-byte load for a value
+// in the 0th to 7th classes.  At least 8 bytes after `last` must be readable,
+// as they are for the bytes of a `PaddedBuffer`.
+auto decode_padded(const char *first, const char *last, std::uint64_t &x)
+    -> decltype(first);
+
+// Decode `n` values as `decode_n` does, with at least 8 bytes after `last`
+// readable.  Unlike `decode_n`, this function never needs to switch to a
+// slower way of decoding the last values in [first, last).
+auto decode_n_padded(const char *first, const char *last, std::uint64_t *x,
+                     const std::size_t n) -> decltype(first);
+
+auto decode_n_padded(const PaddedBuffer &s, std::uint64_t *x,
+                     const std::size_t n) -> const char *;
+
+} // end namespace lttoolbox
+
+#endif
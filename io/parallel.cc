@@ -0,0 +1,322 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "parallel.h"
+#include "decode.h"
+#include "encode.h"
+
+#include <algorithm>
+#include <array>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace lttoolbox {
+
+namespace {
+
+// The fewest bytes worth starting a thread for.
+static constexpr std::size_t minimum_thread_size{1ull << 16ull};
+
+// Return the number of threads to split `size` bytes across.
+static auto get_thread_count(const std::size_t threads,
+                             const std::size_t size) -> std::size_t;
+
+// Call `function` with each of 0, 1, ..., `n` - 1 on its own thread, one of
+// them being this thread, and then wait for all of them to return.  If a
+// thread cannot be started, its call is made on this thread instead.
+template <class Function>
+static void run_parallel(const std::size_t n, Function function);
+
+// The most bytes that the value straddling the start of a part may extend into
+// it, and so the number of bytes its first value may start at.
+static constexpr std::size_t entry_count{9ull};
+
+// Where the values from one entry into a part end, and how many there are.
+struct Walk {
+  const char *s;
+  std::size_t n;
+};
+
+// Walk the first `m` of the `entry_count` entries into [first, s_last), each
+// to the end of the first value that ends at or after `s_last`, which must
+// not extend past `last`, and store the walks in `walks`.  A walk that ends
+// in a truncated value has a null end.  There must be at least `m` bytes in
+// [first, s_last).
+static void walk_entries(const char *first, const char *s_last,
+                         const char *last, const std::size_t m,
+                         std::array<Walk, entry_count> &walks);
+
+// Encode the `n` values starting at `x` into the `size` bytes starting at `s`,
+// which must be exactly what they take, without writing past them.
+static void encode_exact(char *s, const std::uint64_t *x, std::size_t n,
+                         const std::size_t size);
+}
+
+auto decode_parallel(const char *first, const char *last, std::uint64_t *x,
+                     std::size_t &n, const std::size_t threads)
+    -> decltype(first) {
+  const std::size_t thread_count{get_thread_count(threads, last - first)};
+  const auto get_s = [&](const std::size_t i) {
+    return i == thread_count ? last
+                             : first + (last - first) / thread_count * i;
+  };
+
+  // Walk every entry into each part but the first, which starts on a value.
+  std::vector<std::array<Walk, entry_count>> walks(thread_count);
+  run_parallel(thread_count, [&](const std::size_t i) {
+    walk_entries(get_s(i), get_s(i + 1ull), last,
+                 i == 0ull ? 1ull : entry_count, walks[i]);
+  });
+
+  // Follow the walks that start on value boundaries from part to part.
+  std::vector<const char *> s(thread_count + 1ull);
+  std::vector<std::size_t> k(thread_count + 1ull);
+  s[0ull] = first;
+  k[0ull] = 0ull;
+
+  for (std::size_t i{0ull}; i != thread_count; ++i) {
+    const Walk &walk{walks[i][s[i] - get_s(i)]};
+
+    if (walk.s == nullptr)
+      return first;
+
+    s[i + 1ull] = walk.s;
+    k[i + 1ull] = k[i] + walk.n;
+  }
+
+  if (s[thread_count] != last)
+    return first;
+
+  run_parallel(thread_count, [&](const std::size_t i) {
+    decode_n(s[i], s[i + 1ull], x + k[i], k[i + 1ull] - k[i]);
+  });
+  n += k[thread_count];
+  return last;
+}
+
+auto decode_parallel(const char *first, const char *last,
+                     const BlockIndex &index, std::uint64_t *x,
+                     const std::size_t threads) -> decltype(first) {
+  const std::size_t size{index.size()};
+  const std::size_t block_size{index.block_size()};
+  const std::size_t block_count{index.block_count()};
+
+  if (size == 0ull || block_count == 0ull)
+    return first;
+
+  // The offsets do not decrease, so only the last one need be checked.
+  if (index.offset(block_count - 1ull) >
+      static_cast<std::size_t>(last - first))
+    return first;
+
+  // Give each thread the same number of whole blocks.
+  const std::size_t n{get_thread_count(threads, last - first)};
+  const std::size_t blocks_per_thread{(block_count + n - 1ull) / n};
+  const std::size_t thread_count{(block_count + blocks_per_thread - 1ull) /
+                                 blocks_per_thread};
+  std::vector<const char *> s_last(thread_count);
+  run_parallel(thread_count, [&](const std::size_t i) {
+    const std::size_t block{i * blocks_per_thread};
+    const std::size_t block_last{
+        std::min(block + blocks_per_thread, block_count)};
+    const std::size_t k{block * block_size};
+    const std::size_t k_last{std::min(block_last * block_size, size)};
+    const char *const s{first + index.offset(block)};
+    const char *const t{block_last == block_count
+                            ? last
+                            : first + index.offset(block_last)};
+    const char *const next{decode_n(s, t, x + k, k_last - k)};
+
+    // Each range but the last must end exactly where the next one begins.
+    s_last[i] = next == s || (block_last != block_count && next != t)
+                    ? nullptr
+                    : next;
+  });
+
+  for (const auto &t : s_last)
+    if (t == nullptr)
+      return first;
+
+  return s_last.back();
+}
+
+auto encode_parallel(char *s, const std::uint64_t *first,
+                     const std::uint64_t *last, const std::size_t threads)
+    -> decltype(s) {
+  const std::size_t n = last - first;
+  const std::size_t thread_count{
+      get_thread_count(threads, n * sizeof(std::uint64_t))};
+  std::vector<std::size_t> sizes(thread_count + 1ull);
+  const auto get_x = [&](const std::size_t i) {
+    return first + n / thread_count * i + std::min(i, n % thread_count);
+  };
+
+  run_parallel(thread_count, [&](const std::size_t i) {
+    std::size_t size{0ull};
+
+    for (const std::uint64_t *x{get_x(i)}; x != get_x(i + 1ull); ++x)
+      size += encoded_size(*x);
+
+    sizes[i + 1ull] = size;
+  });
+
+  for (std::size_t i{1ull}; i <= thread_count; ++i)
+    sizes[i] += sizes[i - 1ull];
+
+  run_parallel(thread_count, [&](const std::size_t i) {
+    encode_exact(s + sizes[i], get_x(i), get_x(i + 1ull) - get_x(i),
+                 sizes[i + 1ull] - sizes[i]);
+  });
+  return s + sizes[thread_count];
+}
+
+namespace {
+
+auto get_thread_count(const std::size_t threads, const std::size_t size)
+    -> std::size_t {
+  const std::size_t n{threads == 0ull ? std::thread::hardware_concurrency()
+                                      : threads};
+  return std::max<std::size_t>(
+      std::min<std::size_t>(n, size / minimum_thread_size), 1ull);
+}
+
+template <class Function>
+void run_parallel(const std::size_t n, Function function) {
+  std::vector<std::thread> threads{};
+  threads.reserve(n);
+
+  for (std::size_t i{1ull}; i < n; ++i) {
+    try {
+      threads.emplace_back(function, i);
+    } catch (const std::system_error &) {
+      function(i);
+    }
+  }
+
+  function(0ull);
+
+  for (auto &thread : threads)
+    thread.join();
+}
+
+void walk_entries(const char *first, const char *s_last, const char *last,
+                  const std::size_t m, std::array<Walk, entry_count> &walks) {
+  // The entry that each walk has merged into, if any, and how many more
+  // values it had then than that entry.
+  std::size_t to[entry_count];
+  std::size_t n_more[entry_count];
+  std::size_t merged[entry_count];
+  std::size_t merged_count{0ull};
+
+  for (std::size_t i{0ull}; i != m; ++i) {
+    walks[i] = {first + i, 0ull};
+    to[i] = i;
+  }
+
+  const auto is_live = [&](const std::size_t i) {
+    return to[i] == i && walks[i].s != nullptr && walks[i].s < s_last;
+  };
+
+  // Step the walk that is furthest behind, so that a walk that reaches a
+  // value boundary that another has reached finds it there.
+  for (std::size_t live{m}; live > 1ull;) {
+    std::size_t i{m};
+
+    for (std::size_t j{0ull}; j != m; ++j)
+      if (is_live(j) && (i == m || walks[j].s < walks[i].s))
+        i = j;
+
+    if (i == m)
+      break;
+
+    const char *const t{walks[i].s};
+    const std::size_t c{class_table.n[static_cast<unsigned char>(*t)]};
+
+    if (static_cast<std::size_t>(last - t) <= c) {
+      walks[i].s = nullptr;
+      --live;
+      continue;
+    }
+
+    walks[i].s = t + 1ull + c;
+    ++walks[i].n;
+
+    if (walks[i].s >= s_last)
+      --live;
+
+    for (std::size_t j{0ull}; j != m; ++j) {
+      if (j != i && to[j] == j && walks[j].s == walks[i].s) {
+        to[i] = j;
+        n_more[i] = walks[i].n - walks[j].n;
+        merged[merged_count++] = i;
+        live -= walks[i].s < s_last;
+        break;
+      }
+    }
+  }
+
+  // Finish the walk that is left, if any, and then the value that straddles
+  // `s_last`.
+  for (std::size_t i{0ull}; i != m; ++i) {
+    if (to[i] != i || walks[i].s == nullptr || walks[i].s >= s_last)
+      continue;
+
+    const char *const t{validate(walks[i].s, s_last, walks[i].n)};
+
+    if (t == s_last) {
+      walks[i].s = t;
+      continue;
+    }
+
+    const std::size_t c{class_table.n[static_cast<unsigned char>(*t)]};
+
+    if (static_cast<std::size_t>(last - t) <= c) {
+      walks[i].s = nullptr;
+      continue;
+    }
+
+    walks[i].s = t + 1ull + c;
+    ++walks[i].n;
+  }
+
+  // Each walk merged into one that was still walking then, so resolving them
+  // in reverse resolves every walk that it merged into first.
+  while (merged_count != 0ull) {
+    const std::size_t i{merged[--merged_count]};
+    walks[i] = {walks[to[i]].s, walks[to[i]].n + n_more[i]};
+  }
+}
+
+void encode_exact(char *s, const std::uint64_t *x, std::size_t n,
+                  const std::size_t size) {
+  char *const s_last{s + size};
+
+  // `encode_n` may write to any of the 9 bytes per value after `s`, so encode
+  // only as many values at once as there are 9 bytes left for.
+  for (std::size_t m; (m = std::min<std::size_t>(n, (s_last - s) / 9)) != 0ull;
+       n -= m, x += m)
+    s = encode_n(s, x, m);
+
+  // Fewer than 9 bytes are left, so encode the values that remain elsewhere
+  // and then copy them.
+  for (; n != 0ull; --n, ++x) {
+    char t[9ull];
+    s = std::copy(t, encode(t, *x), s);
+  }
+}
+}
+
+} // end namespace lttoolbox
@@ -0,0 +1,72 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_PARALLEL_H
+#define APERTIUM_LTTOOLBOX_PARALLEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "block_index.h"
+
+namespace lttoolbox {
+
+// Decode every value in [first, last) with up to `threads` threads, or, if
+// `threads` is 0, one per hardware thread, into the elements starting at `x`,
+// add the number of values to `n`, and then return `last`.  There must be an
+// element for each value, for which `last` - `first` elements always suffice,
+// and they are written to only by the threads that decode into them.
+//
+// The format is not self-synchronizing, so each thread first walks the first
+// bytes of its part of the buffer, as `validate` does (see decode.h), from
+// each of the 9 bytes that the first value in it may start at.  The walks
+// usually meet within a few values, after which only one is continued.  Then
+// the walk that starts where the values of the previous part end is picked
+// for each part in turn, and each thread decodes its part with `decode_n`.
+// If the last value is truncated, this function returns `first`, leaves `n`
+// as it was, and the values of the elements are unspecified.
+auto decode_parallel(const char *first, const char *last, std::uint64_t *x,
+                     std::size_t &n, const std::size_t threads = 0ull)
+    -> decltype(first);
+
+// Decode the `index.size()` values in [first, last) that `index` indexes into
+// the elements starting at `x` with up to `threads` threads, and then return a
+// pointer to the byte after the last value.
+//
+// The block offsets are the split points, so no pass is needed before
+// decoding.  If a value is truncated, or the index does not match the
+// buffer, this function returns `first`, and the values of the elements are
+// unspecified.
+auto decode_parallel(const char *first, const char *last,
+                     const BlockIndex &index, std::uint64_t *x,
+                     const std::size_t threads = 0ull) -> decltype(first);
+
+// Encode the values in [first, last) with up to `threads` threads, or, if
+// `threads` is 0, one per hardware thread, into the bytes starting at `s`, and
+// then return a pointer to the byte after the last one.  `s` must point to at
+// least `encoded_size(first, last)` writable bytes (see encode.h), and no byte
+// after the last value is written.
+//
+// Each value's position depends on the sizes of all the values before it, so
+// the threads first sum the sizes of their values with `encoded_size`.  Then
+// each thread encodes its values directly into its part of the bytes, which
+// no other thread writes to.
+auto encode_parallel(char *s, const std::uint64_t *first,
+                     const std::uint64_t *last,
+                     const std::size_t threads = 0ull) -> decltype(s);
+
+} // end namespace lttoolbox
+
+#endif
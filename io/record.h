@@ -0,0 +1,231 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_RECORD_H
+#define APERTIUM_LTTOOLBOX_RECORD_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <istream>
+#include <ostream>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "decode.h"
+#include "encode.h"
+#include "streambuf.h"
+
+namespace lttoolbox {
+
+// A record is a fixed sequence of fields, such as the input symbol, output
+// symbol, target state and weight of a transition, encoded one after another
+// as `encode` encodes each of them.  The schema of a record is the types of a
+// `std::tuple`, so the fields of a struct can be encoded and decoded in one
+// call with `std::tie`:
+//
+//   encode_record(os, std::tie(t.input, t.output, t.target, t.weight));
+//   decode_record(is, std::tie(t.input, t.output, t.target, t.weight));
+//
+// Each field can be of any type that `encode` and `decode` have an overload
+// for: `std::uint64_t`, a narrow unsigned integer type, `double`, or `float`.
+// A signed field would need `encode_zigzag`, so it is not supported.
+
+// Return the greatest number of bytes that a value of type `T` is encoded in.
+template <class T> constexpr std::size_t get_maximum_size() {
+  return encoded_size(sizeof(T) >= 8ull
+                          ? ~0ull
+                          : (1ull << (8ull * sizeof(T))) - 1ull);
+}
+
+// Return the greatest number of bytes that `encode_record` writes for a record
+// with fields of types `T...`, including those that `encode` may overwrite
+// after the last field, which is known at compile time.
+template <class... T> constexpr std::size_t get_record_capacity() {
+  const std::size_t sizes[]{
+      0ull, get_maximum_size<typename std::decay<T>::type>()...};
+  std::size_t size{encode_overwrite_size};
+
+  for (const auto &field_size : sizes)
+    size += field_size;
+
+  return size;
+}
+
+// Encode the fields of `x` into the bytes starting at `s` and then return a
+// pointer to the byte after the last one.  `s` must point to at least
+// `get_record_capacity<T...>()` writable bytes.
+template <class... T>
+auto encode_record(char *s, const std::tuple<T...> &x) -> decltype(s);
+
+// Encode the fields of `x` as above and then write them to `os`.
+//
+// If the put area of the buffer of `os` has room for
+// `get_record_capacity<T...>()` bytes, the fields are encoded directly into it
+// after only that check; otherwise, they are encoded into a local buffer and
+// then written in one call.
+template <class... T>
+auto encode_record(std::ostream &os, const std::tuple<T...> &x)
+    -> decltype(os);
+
+// Decode a record from the bytes in [first, last) into the fields of `x` and
+// then return a pointer to the byte after it.  If [first, last) does not hold
+// a whole record, or if a field does not fit in its type, this function
+// returns `first` and leaves `x` unchanged.
+template <class... T>
+auto decode_record(const char *first, const char *last, std::tuple<T...> &x)
+    -> decltype(first);
+template <class... T>
+auto decode_record(const char *first, const char *last, std::tuple<T &...> &&x)
+    -> decltype(first);
+
+// Decode a record from `is` as above.  If the get area of the buffer of `is`
+// holds the whole record, it is decoded directly from there and then
+// extracted at once; otherwise, the fields are decoded one at a time.  If the
+// record is truncated or a field does not fit in its type, `failbit` is set,
+// and `x` is left unchanged.
+template <class... T>
+auto decode_record(std::istream &is, std::tuple<T...> &x) -> decltype(is);
+template <class... T>
+auto decode_record(std::istream &is, std::tuple<T &...> &&x) -> decltype(is);
+
+namespace {
+
+// Decode `x` as `decode` does, but return null if `s` is null or if `x` is
+// truncated or does not fit, so that a failure passes through the remaining
+// fields of a record.
+template <class T>
+inline auto decode_field(const char *s, const char *last, T &x)
+    -> const char *;
+
+// Encode or decode each field of `x` in turn.
+template <class... T, std::size_t... i>
+auto encode_fields(char *s, const std::tuple<T...> &x,
+                   std::index_sequence<i...>) -> decltype(s);
+template <class... T, std::size_t... i>
+auto decode_fields(const char *s, const char *last, std::tuple<T...> &x,
+                   std::index_sequence<i...>) -> decltype(s);
+template <class... T, std::size_t... i>
+auto decode_fields(std::istream &is, std::tuple<T...> &x,
+                   std::index_sequence<i...>) -> decltype(is);
+}
+
+template <class... T>
+auto encode_record(char *s, const std::tuple<T...> &x) -> decltype(s) {
+  return encode_fields(s, x, std::index_sequence_for<T...>{});
+}
+
+template <class... T>
+auto encode_record(std::ostream &os, const std::tuple<T...> &x)
+    -> decltype(os) {
+  constexpr std::size_t capacity{get_record_capacity<T...>()};
+  char *const s{StreambufAccess::get_put_area(os, capacity)};
+
+  if (s != nullptr) {
+    StreambufAccess::bump_put(*os.rdbuf(), encode_record(s, x) - s);
+    return os;
+  }
+
+  char t[capacity];
+  return os.write(t, encode_record(t, x) - t);
+}
+
+template <class... T>
+auto decode_record(const char *first, const char *last, std::tuple<T...> &x)
+    -> decltype(first) {
+  std::tuple<typename std::decay<T>::type...> y{};
+  const char *const s{
+      decode_fields(first, last, y, std::index_sequence_for<T...>{})};
+
+  if (s == nullptr)
+    return first;
+
+  x = y;
+  return s;
+}
+
+template <class... T>
+auto decode_record(const char *first, const char *last, std::tuple<T &...> &&x)
+    -> decltype(first) {
+  return decode_record(first, last, x);
+}
+
+template <class... T>
+auto decode_record(std::istream &is, std::tuple<T...> &x) -> decltype(is) {
+  const char *last{nullptr};
+  const char *const first{StreambufAccess::get_get_area(is, last)};
+
+  if (first != last) {
+    const char *const s{decode_record(first, last, x)};
+
+    if (s != first) {
+      StreambufAccess::bump_get(*is.rdbuf(), s - first);
+      return is;
+    }
+  }
+
+  std::tuple<typename std::decay<T>::type...> y{};
+
+  if (decode_fields(is, y, std::index_sequence_for<T...>{}))
+    x = y;
+
+  return is;
+}
+
+template <class... T>
+auto decode_record(std::istream &is, std::tuple<T &...> &&x) -> decltype(is) {
+  return decode_record(is, x);
+}
+
+namespace {
+
+template <class T>
+auto decode_field(const char *s, const char *last, T &x) -> const char * {
+  if (s == nullptr)
+    return nullptr;
+
+  const char *const next{decode(s, last, x)};
+  return next == s ? nullptr : next;
+}
+
+template <class... T, std::size_t... i>
+auto encode_fields(char *s, const std::tuple<T...> &x,
+                   std::index_sequence<i...>) -> decltype(s) {
+  const int expand[]{0, (s = encode(s, std::get<i>(x)), 0)...};
+  static_cast<void>(expand);
+  return s;
+}
+
+template <class... T, std::size_t... i>
+auto decode_fields(const char *s, const char *last, std::tuple<T...> &x,
+                   std::index_sequence<i...>) -> decltype(s) {
+  const int expand[]{0, (s = decode_field(s, last, std::get<i>(x)), 0)...};
+  static_cast<void>(expand);
+  return s;
+}
+
+template <class... T, std::size_t... i>
+auto decode_fields(std::istream &is, std::tuple<T...> &x,
+                   std::index_sequence<i...>) -> decltype(is) {
+  const int expand[]{0, (is && decode(is, std::get<i>(x)), 0)...};
+  static_cast<void>(expand);
+  return is;
+}
+}
+
+} // end namespace lttoolbox
+
+#endif
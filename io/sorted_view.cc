@@ -0,0 +1,194 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sorted_view.h"
+#include "decode.h"
+#include "encode.h"
+
+namespace lttoolbox {
+
+auto encode_sorted(char *s, const std::uint64_t *x, const std::size_t n,
+                   const std::size_t block_size) -> decltype(s) {
+  // Find the size of the block data first so that everything can be written
+  // in order in one more pass.
+  std::uint64_t data_size{0ull};
+
+  for (std::size_t i{0ull}; i != n; ++i)
+    if (i % block_size != 0ull)
+      data_size +=
+          1ull + bit_length_table.n[get_bit_length(x[i] - x[i - 1ull])];
+
+  s = encode(s, std::uint64_t{n});
+  s = encode(s, std::uint64_t{block_size});
+  s = encode(s, data_size);
+  char *header{s};
+  char *const data{s + 16ull * (n / block_size + (n % block_size != 0ull))};
+  s = data;
+
+  for (std::size_t i{0ull}; i != n; ++i) {
+    if (i % block_size == 0ull) {
+      store_big_endian(header, x[i]);
+      store_big_endian(header + 8ull, s - data);
+      header += 16ull;
+    } else {
+      s = encode(s, x[i] - x[i - 1ull]);
+    }
+  }
+
+  return s;
+}
+
+SortedView::SortedView()
+    : headers{nullptr}, data{nullptr}, data_last{nullptr}, size_{0ull},
+      block_size{1ull}, block_count{0ull}, good_{true} {}
+
+SortedView::SortedView(const char *first, const char *last) : SortedView{} {
+  std::uint64_t n{0ull};
+  std::uint64_t m{0ull};
+  std::uint64_t data_size{0ull};
+  const char *const s_n{decode(first, last, n)};
+  const char *const s_m{decode(s_n, last, m)};
+  const char *const s{decode(s_m, last, data_size)};
+
+  if (s_n == first || s_m == s_n || s == s_m || m == 0ull) {
+    good_ = false;
+    return;
+  }
+
+  // Check the sizes by division so that nothing can overflow.
+  const std::uint64_t count{n / m + (n % m != 0ull)};
+
+  if (count > static_cast<std::uint64_t>(last - s) / 16ull ||
+      data_size > static_cast<std::uint64_t>(last - s) - 16ull * count) {
+    good_ = false;
+    return;
+  }
+
+  headers = s;
+  data = s + 16ull * count;
+  data_last = data + data_size;
+  size_ = n;
+  block_size = m;
+  block_count = count;
+}
+
+auto SortedView::good() const -> bool { return good_; }
+
+auto SortedView::size() const -> std::size_t { return size_; }
+
+auto SortedView::empty() const -> bool { return size_ == 0ull; }
+
+auto SortedView::tell() const -> const char * { return data_last; }
+
+auto SortedView::lower_bound(const std::uint64_t x) const -> std::size_t {
+  std::uint64_t y{0ull};
+  return find(x, y);
+}
+
+auto SortedView::contains(const std::uint64_t x) const -> bool {
+  std::uint64_t y{0ull};
+  return find(x, y) != size_ && y == x;
+}
+
+auto SortedView::get(const std::size_t k, std::uint64_t &x) const -> bool {
+  if (k >= size_)
+    return false;
+
+  const std::size_t block{k / block_size};
+  std::uint64_t y{get_first_value(block)};
+  const char *s{get_block(block)};
+
+  for (std::size_t i{block * block_size}; i != k; ++i) {
+    std::uint64_t difference{0ull};
+    const char *const next{decode(s, data_last, difference)};
+
+    if (next == s)
+      return false;
+
+    s = next;
+    y += difference;
+  }
+
+  x = y;
+  return true;
+}
+
+auto SortedView::find(const std::uint64_t x, std::uint64_t &y) const
+    -> std::size_t {
+  // Count the blocks whose first values are less than `x`.  The first value
+  // no less than `x` is either in the last of them or first in the next one.
+  std::size_t low{0ull};
+  std::size_t high{block_count};
+
+  while (low != high) {
+    const std::size_t middle{low + (high - low) / 2ull};
+
+    if (get_first_value(middle) < x)
+      low = middle + 1ull;
+    else
+      high = middle;
+  }
+
+  if (low == 0ull) {
+    if (size_ != 0ull)
+      y = get_first_value(0ull);
+
+    return 0ull;
+  }
+
+  const std::size_t block{low - 1ull};
+  const std::size_t block_first{block * block_size};
+  const std::size_t block_last{
+      block_first + block_size < size_ ? block_first + block_size : size_};
+  std::uint64_t z{get_first_value(block)};
+  const char *s{get_block(block)};
+
+  for (std::size_t i{block_first + 1ull}; i != block_last; ++i) {
+    std::uint64_t difference{0ull};
+    const char *const next{decode(s, data_last, difference)};
+
+    if (next == s)
+      break;
+
+    s = next;
+    z += difference;
+
+    if (z >= x) {
+      y = z;
+      return i;
+    }
+  }
+
+  if (low != block_count)
+    y = get_first_value(low);
+
+  return block_last;
+}
+
+auto SortedView::get_first_value(const std::size_t block) const
+    -> std::uint64_t {
+  return load_big_endian(headers + 16ull * block);
+}
+
+auto SortedView::get_block(const std::size_t block) const -> const char * {
+  const std::uint64_t offset{load_big_endian(headers + 16ull * block + 8ull)};
+
+  if (offset > static_cast<std::uint64_t>(data_last - data))
+    return data_last;
+
+  return data + offset;
+}
+
+} // end namespace lttoolbox
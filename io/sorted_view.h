@@ -0,0 +1,99 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_SORTED_VIEW_H
+#define APERTIUM_LTTOOLBOX_SORTED_VIEW_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lttoolbox {
+
+// Encode the `n` values starting at `x`, which must be sorted in nondecreasing
+// order, as a searchable sequence and then return a pointer to the byte after
+// it.
+//
+// A searchable sequence is split into blocks of `block_size` values.  It is
+// the number of values, the block size, and the number of bytes of block
+// data, each encoded in Apertium binary format, then a header for each block,
+// and then the block data.  Each header is the first value of its block and
+// the offset of the rest of the block in the block data, both as 8-byte
+// big-endian integers, so that the headers can be binary searched.  The rest
+// of each block is the difference between each value and the one before it.
+//
+// `block_size` must be positive, and `s` must point to at least
+// `get_sorted_capacity(n, block_size)` writable bytes.
+auto encode_sorted(char *s, const std::uint64_t *x, const std::size_t n,
+                   const std::size_t block_size = 128ull) -> decltype(s);
+
+// Return the greatest number of bytes that `encode_sorted` writes.
+constexpr std::size_t get_sorted_capacity(const std::size_t n,
+                                          const std::size_t block_size) {
+  return 27ull + 16ull * (n / block_size + (n % block_size != 0ull)) +
+         9ull * n;
+}
+
+// A view of a sequence encoded by `encode_sorted`, which finds values by
+// binary searching the block headers and then decoding at most one block.
+//
+// The view neither copies nor allocates; the bytes must outlive it.  If the
+// numbers and headers at the start of the sequence are truncated, `good`
+// returns false and the view is empty.  A block whose data is truncated is
+// treated as if it ended early.
+class SortedView {
+public:
+  SortedView();
+  SortedView(const char *first, const char *last);
+
+  auto good() const -> bool;
+  auto size() const -> std::size_t;
+  auto empty() const -> bool;
+
+  // A pointer to the byte after the sequence.
+  auto tell() const -> const char *;
+
+  // Return the index of the first value no less than `x`, or `size` if there
+  // is none.
+  auto lower_bound(const std::uint64_t x) const -> std::size_t;
+
+  auto contains(const std::uint64_t x) const -> bool;
+
+  // Decode the kth value into `x` and then return true, or, if there is no kth
+  // value, return false and leave `x` unchanged.
+  auto get(const std::size_t k, std::uint64_t &x) const -> bool;
+
+private:
+  // Return the index of the first value no less than `x`, and, if there is
+  // one, set `y` to it.
+  auto find(const std::uint64_t x, std::uint64_t &y) const -> std::size_t;
+
+  auto get_first_value(const std::size_t block) const -> std::uint64_t;
+
+  // Return a pointer to the differences in the `block`th block, or, if the
+  // header is corrupt, to the end of the block data.
+  auto get_block(const std::size_t block) const -> const char *;
+
+  const char *headers;
+  const char *data;
+  const char *data_last;
+  std::size_t size_;
+  std::size_t block_size;
+  std::size_t block_count;
+  bool good_;
+};
+
+} // end namespace lttoolbox
+
+#endif
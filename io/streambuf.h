@@ -0,0 +1,86 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_STREAMBUF_H
+#define APERTIUM_LTTOOLBOX_STREAMBUF_H
+
+#include <cstddef>
+
+#include <istream>
+#include <ostream>
+#include <streambuf>
+
+namespace lttoolbox {
+
+// Access to the get and put areas of a `std::streambuf`, which are protected,
+// so that values can be encoded and decoded directly in them.
+//
+// A pointer to a protected member can be formed in a derived class and then
+// applied to any object of the base class.
+class StreambufAccess : public std::streambuf {
+public:
+  static auto get_gptr(std::streambuf &b) -> char * {
+    return (b.*&StreambufAccess::gptr)();
+  }
+
+  static auto get_egptr(std::streambuf &b) -> char * {
+    return (b.*&StreambufAccess::egptr)();
+  }
+
+  static void bump_get(std::streambuf &b, const int n) {
+    (b.*&StreambufAccess::gbump)(n);
+  }
+
+  static auto get_pptr(std::streambuf &b) -> char * {
+    return (b.*&StreambufAccess::pptr)();
+  }
+
+  static auto get_epptr(std::streambuf &b) -> char * {
+    return (b.*&StreambufAccess::epptr)();
+  }
+
+  static void bump_put(std::streambuf &b, const int n) {
+    (b.*&StreambufAccess::pbump)(n);
+  }
+
+  // Return the get area of the buffer of `is` and set `last` to its end, or,
+  // if the sentry would have to do anything first, return null.  A tied
+  // stream must be flushed first, so null is returned for a stream with one.
+  static auto get_get_area(std::istream &is, const char *&last)
+      -> const char * {
+    if (!is.good() || is.tie() != nullptr)
+      return nullptr;
+
+    last = get_egptr(*is.rdbuf());
+    return get_gptr(*is.rdbuf());
+  }
+
+  // Return the put area of the buffer of `os` if at least `size` bytes are
+  // left in it, or otherwise null.  The sentry would flush a tied stream
+  // first, and a stream with `unitbuf` set after, so null is returned for
+  // those.
+  static auto get_put_area(std::ostream &os, const std::ptrdiff_t size)
+      -> char * {
+    if (!os.good() || os.tie() != nullptr || (os.flags() & os.unitbuf) != 0)
+      return nullptr;
+
+    char *const s{get_pptr(*os.rdbuf())};
+    return get_epptr(*os.rdbuf()) - s < size ? nullptr : s;
+  }
+};
+
+} // end namespace lttoolbox
+
+#endif
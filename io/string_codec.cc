@@ -0,0 +1,246 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "string_codec.h"
+#include "decode.h"
+
+#include <cstring>
+
+namespace lttoolbox {
+
+namespace {
+
+// Decode the `n` characters of a string from the bytes in [first, last) into
+// the `n` elements starting at `x` and then return a pointer to the byte after
+// the last one, or, if they are not all there or do not fit in `C`, return
+// `first`.
+template <class C>
+static auto decode_characters(const char *first, const char *last, C *x,
+                              std::size_t n) -> decltype(first);
+
+// A pointer to `size` bytes on the stack if they fit there, or otherwise on
+// the heap.
+class Buffer {
+public:
+  explicit Buffer(const std::size_t size);
+  auto data() -> char *;
+
+private:
+  char local[256ull];
+  std::vector<char> heap;
+  char *data_;
+};
+}
+
+template <class C>
+auto encode_string(char *s, const C *x, const std::size_t n) -> decltype(s) {
+  s = encode(s, std::uint64_t{n});
+
+  for (const C *const x_last{x + n}; x != x_last; ++x) {
+    const CodePoint<C> c{static_cast<CodePoint<C>>(*x)};
+
+    if (c < 0x80u)
+      *s++ = static_cast<char>(c);
+    else
+      s = encode(s, c);
+  }
+
+  return s;
+}
+
+template <class C>
+auto encode_string(std::ostream &os, const std::basic_string<C> &x)
+    -> decltype(os) {
+  Buffer s{get_string_capacity<C>(x.size())};
+  return os.write(s.data(), encode_string(s.data(), x.data(), x.size()) -
+                                s.data());
+}
+
+template <class C>
+auto decode_string(const char *first, const char *last,
+                   std::basic_string<C> &x) -> decltype(first) {
+  std::uint64_t n{0ull};
+  const char *const s{decode_count(first, last, n)};
+
+  if (s == first)
+    return first;
+
+  x.resize(n);
+  const char *const next{decode_characters(s, last, &x[0ull], n)};
+  return next == s && n != 0ull ? first : next;
+}
+
+template <class C>
+auto decode_string(std::istream &is, std::basic_string<C> &x) -> decltype(is) {
+  std::uint64_t n{0ull};
+
+  if (!decode(is, n))
+    return is;
+
+  // Do not trust the length enough to reserve more than a little at first.
+  x.clear();
+  x.reserve(std::min<std::uint64_t>(n, 0x100ull));
+
+  for (CodePoint<C> c{0u}; n != 0ull && decode(is, c); --n)
+    x.push_back(static_cast<C>(c));
+
+  return is;
+}
+
+template <class C>
+StringTable<C>::StringTable() : characters{}, offsets{0ull} {}
+
+template <class C>
+void StringTable<C>::reserve(const std::size_t n, const std::size_t size) {
+  characters.reserve(characters.size() + size + n);
+  offsets.reserve(offsets.size() + n);
+}
+
+template <class C>
+auto StringTable<C>::decode(const char *first, const char *last,
+                            const std::size_t n) -> decltype(first) {
+  const std::size_t size{characters.size()};
+  const std::size_t count{offsets.size()};
+  const char *s{first};
+
+  for (std::size_t i{0ull}; i != n; ++i) {
+    std::uint64_t length{0ull};
+    const char *next{decode_count(s, last, length)};
+
+    if (next == s) {
+      characters.resize(size);
+      offsets.resize(count);
+      return first;
+    }
+
+    s = next;
+    const std::size_t offset{characters.size()};
+    // Each string is followed by a null character, which `resize` adds.
+    characters.resize(offset + length + 1ull);
+    next = decode_characters(s, last, characters.data() + offset, length);
+
+    if (next == s && length != 0ull) {
+      characters.resize(size);
+      offsets.resize(count);
+      return first;
+    }
+
+    s = next;
+    offsets.push_back(characters.size());
+  }
+
+  return s;
+}
+
+template <class C> auto StringTable<C>::size() const -> std::size_t {
+  return offsets.size() - 1ull;
+}
+
+template <class C> auto StringTable<C>::empty() const -> bool {
+  return offsets.size() == 1ull;
+}
+
+template <class C>
+auto StringTable<C>::data(const std::size_t k) const -> const C * {
+  return characters.data() + offsets[k];
+}
+
+template <class C>
+auto StringTable<C>::length(const std::size_t k) const -> std::size_t {
+  return offsets[k + 1ull] - offsets[k] - 1ull;
+}
+
+template <class C>
+auto StringTable<C>::string(const std::size_t k) const
+    -> std::basic_string<C> {
+  return {data(k), length(k)};
+}
+
+template auto encode_string(char *s, const char *x, const std::size_t n)
+    -> char *;
+template auto encode_string(char *s, const wchar_t *x, const std::size_t n)
+    -> char *;
+template auto encode_string(std::ostream &os, const std::string &x)
+    -> std::ostream &;
+template auto encode_string(std::ostream &os, const std::wstring &x)
+    -> std::ostream &;
+template auto decode_string(const char *first, const char *last,
+                            std::string &x) -> const char *;
+template auto decode_string(const char *first, const char *last,
+                            std::wstring &x) -> const char *;
+template auto decode_string(std::istream &is, std::string &x)
+    -> std::istream &;
+template auto decode_string(std::istream &is, std::wstring &x)
+    -> std::istream &;
+template class StringTable<char>;
+template class StringTable<wchar_t>;
+
+namespace {
+
+template <class C>
+auto decode_characters(const char *first, const char *last, C *x,
+                       std::size_t n) -> decltype(first) {
+  static constexpr std::uint64_t high_bits{0x80'80'80'80'80'80'80'80ull};
+  const char *s{first};
+
+  while (n != 0ull) {
+    // Copy a run of ASCII characters 8 at a time.
+    for (std::uint64_t y{0ull}; n >= 8ull && last - s >= 8; n -= 8ull) {
+      std::memcpy(&y, s, sizeof(y));
+
+      if ((y & high_bits) != 0ull)
+        break;
+
+      for (std::size_t i{0ull}; i != 8ull; ++i)
+        x[i] = static_cast<C>(s[i]);
+
+      s += 8;
+      x += 8;
+    }
+
+    if (n == 0ull)
+      break;
+
+    if (s == last)
+      return first;
+
+    if (static_cast<unsigned char>(*s) < 0x80u) {
+      *x++ = static_cast<C>(*s++);
+      --n;
+      continue;
+    }
+
+    CodePoint<C> c{0u};
+    const char *const next{decode(s, last, c)};
+
+    if (next == s)
+      return first;
+
+    *x++ = static_cast<C>(c);
+    s = next;
+    --n;
+  }
+
+  return s;
+}
+
+Buffer::Buffer(const std::size_t size)
+    : heap(size > sizeof(local) ? size : 0ull),
+      data_{heap.empty() ? local : heap.data()} {}
+
+auto Buffer::data() -> char * { return data_; }
+}
+
+} // end namespace lttoolbox
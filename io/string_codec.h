@@ -0,0 +1,120 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_STRING_CODEC_H
+#define APERTIUM_LTTOOLBOX_STRING_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "encode.h"
+
+namespace lttoolbox {
+
+// The unsigned type that each character of a string of `C` is encoded as, so
+// that, for example, a `char` greater than 0x7f is not sign-extended.
+template <class C> using CodePoint = typename std::make_unsigned<C>::type;
+
+// Encode the `n` characters starting at `x` as a string and then return a
+// pointer to the byte after it.
+//
+// A string is its length in characters and then each character, all encoded
+// in Apertium binary format.  Each character less than 0x80 is encoded as
+// itself in 1 byte, so a run of ASCII characters is a run of ASCII bytes.
+// `C` is `char` or `wchar_t`, and `s` must point to at least
+// `get_string_capacity<C>(n)` writable bytes.
+template <class C>
+auto encode_string(char *s, const C *x, const std::size_t n) -> decltype(s);
+
+// Encode `x` as above into a local buffer and then write it to `os` in one
+// call.
+template <class C>
+auto encode_string(std::ostream &os, const std::basic_string<C> &x)
+    -> decltype(os);
+
+// Return the greatest number of bytes that `encode_string` writes for `n`
+// characters, including those that `encode` may overwrite after the last one.
+template <class C>
+constexpr std::size_t get_string_capacity(const std::size_t n) {
+  return 9ull + n * encoded_size(std::numeric_limits<CodePoint<C>>::max()) +
+         encode_overwrite_size;
+}
+
+// Decode a string encoded by `encode_string` from the bytes in [first, last)
+// into `x` and then return a pointer to the byte after it.
+//
+// Runs of ASCII bytes are found and copied 8 bytes at a time, and only the
+// other characters are decoded one at a time.  If [first, last) does not hold
+// a whole string, or if a character does not fit in `C`, this function
+// returns `first`, and the contents of `x` are unspecified.
+template <class C>
+auto decode_string(const char *first, const char *last,
+                   std::basic_string<C> &x) -> decltype(first);
+
+// Decode a string as above from `is`, one character at a time.  If the string
+// is truncated or a character does not fit in `C`, this function sets
+// `failbit`, and the contents of `x` are unspecified.
+template <class C>
+auto decode_string(std::istream &is, std::basic_string<C> &x) -> decltype(is);
+
+// A table of strings decoded into one contiguous block of characters, such as
+// the symbols of an alphabet, so that decoding thousands of strings allocates
+// only a few times rather than once per string.
+//
+// Each string is followed by a null character, so `data` can be passed where
+// a null-terminated string is expected.  The pointers that `data` returns are
+// invalidated by `decode`.
+template <class C> class StringTable {
+public:
+  StringTable();
+
+  // Reserve room for `n` more strings with `size` more characters in total.
+  void reserve(const std::size_t n, const std::size_t size);
+
+  // Decode `n` strings encoded one after another by `encode_string` from the
+  // bytes in [first, last), append them to the table, and then return a
+  // pointer to the byte after the last one.  If [first, last) does not hold
+  // `n` whole strings, or if a character does not fit in `C`, this function
+  // returns `first` and leaves the table as it was.
+  auto decode(const char *first, const char *last, const std::size_t n)
+      -> decltype(first);
+
+  // The number of strings.
+  auto size() const -> std::size_t;
+  auto empty() const -> bool;
+
+  // The kth string, its length, and a copy of it.
+  auto data(const std::size_t k) const -> const C *;
+  auto length(const std::size_t k) const -> std::size_t;
+  auto string(const std::size_t k) const -> std::basic_string<C>;
+
+private:
+  std::vector<C> characters;
+
+  // The offset of each string in `characters`, and then the offset after the
+  // last one.
+  std::vector<std::size_t> offsets;
+};
+
+} // end namespace lttoolbox
+
+#endif
@@ -0,0 +1,55 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef APERTIUM_LTTOOLBOX_ZIGZAG_H
+#define APERTIUM_LTTOOLBOX_ZIGZAG_H
+
+#include <cstddef>
+
+#include <type_traits>
+
+namespace lttoolbox {
+
+// Return the unsigned value that `x` is encoded as by `encode_zigzag`.
+//
+// A signed value is mapped so that values of small magnitude, whether negative
+// or not, are mapped to small values: 0, -1, 1, -2, 2, ... are mapped to 0, 1,
+// 2, 3, 4, ....  Thus, -1 is in the 0th class rather than the greatest class
+// for its width.  An unsigned value is mapped to itself.
+template <class T>
+constexpr auto to_zigzag(const T x) -> typename std::make_unsigned<T>::type {
+  using U = typename std::make_unsigned<T>::type;
+  constexpr std::size_t sign_bit{8ull * sizeof(T) - 1ull};
+  return std::is_signed<T>::value
+             ? static_cast<U>(static_cast<U>(static_cast<U>(x) << 1u) ^
+                              static_cast<U>(0u - (static_cast<U>(x) >>
+                                                   sign_bit)))
+             : static_cast<U>(x);
+}
+
+// Return the value of type `T` that is encoded as `x`.  This is the inverse of
+// `to_zigzag`.
+template <class T>
+constexpr T from_zigzag(const typename std::make_unsigned<T>::type x) {
+  using U = typename std::make_unsigned<T>::type;
+  return std::is_signed<T>::value
+             ? static_cast<T>(static_cast<U>(static_cast<U>(x >> 1u) ^
+                                             static_cast<U>(0u - (x & 1u))))
+             : static_cast<T>(x);
+}
+
+} // end namespace lttoolbox
+
+#endif
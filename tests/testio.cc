@@ -16,14 +16,58 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
 #include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 #define BOOST_TEST_MODULE testio
 #include <boost/test/included/unit_test.hpp>
 
+#include <unistd.h>
+
+#include "bit_packed.h"
+#include "block_index.h"
 #include "decode.h"
+#include "decode_iterator.h"
+#include "delta.h"
 #include "encode.h"
+#include "encode_writer.h"
+#include "group_varint.h"
+#include "kernel.h"
+#include "mapped_decoder.h"
+#include "padded.h"
+#include "parallel.h"
+#include "record.h"
+#include "sorted_view.h"
+#include "string_codec.h"
+
+// A stream buffer whose get and put areas are only `size` bytes, so that
+// values straddle their boundaries.
+class SmallStreambuf : public std::streambuf {
+public:
+  SmallStreambuf(const std::string &s, const std::size_t size);
+
+  std::string s;
+
+protected:
+  auto underflow() -> int_type override;
+  auto overflow(const int_type c) -> int_type override;
+  auto sync() -> int override;
+
+private:
+  std::size_t size;
+  std::size_t i;
+  char put[16ull];
+};
 
 static inline unsigned int ord(const char &c);
 template <class InputIterator>
@@ -36,6 +80,25 @@ template <std::size_t n>
 static bool test_encode(const std::uint64_t x, const std::array<char, n> &s);
 template <std::size_t n>
 static bool test_decode(const std::array<char, n> &s, const std::uint64_t x);
+template <std::size_t n>
+static bool test_encode_buffer(const std::uint64_t x,
+                               const std::array<char, n> &s);
+template <std::size_t n>
+static bool test_decode_buffer(const std::array<char, n> &s,
+                               const std::uint64_t x);
+template <std::size_t n>
+static bool test_decode_padded(const std::array<char, n> &s,
+                               const std::uint64_t x);
+template <class T, std::size_t n>
+static void test_narrow(const T x, const std::array<char, n> &s);
+static auto generate_symbols(const std::uint64_t seed)
+    -> std::vector<std::uint64_t>;
+
+// Return the kernel of each operation, to be restored with `set_kernels`.
+static auto get_kernels()
+    -> std::array<lttoolbox::Kernel, lttoolbox::operation_count>;
+static void set_kernels(
+    const std::array<lttoolbox::Kernel, lttoolbox::operation_count> &kernels);
 
 BOOST_AUTO_TEST_CASE(class0_minimum_x) {
   test(0x00ull, std::array<char, 1ull>({'\x00'}));
@@ -174,6 +237,1616 @@ BOOST_AUTO_TEST_CASE(class8_maximum_x) {
                                '\xff', '\xff', '\xff'}));
 }
 
+BOOST_AUTO_TEST_CASE(stream_buffer_boundaries) {
+  const std::vector<std::uint64_t> xs{generate_symbols(0x100ull)};
+  std::vector<char> expected(9ull * xs.size());
+  expected.resize(lttoolbox::encode_n(expected.data(), xs.data(), xs.size()) -
+                  expected.data());
+
+  // Values are encoded directly into put areas of 16 bytes but not of 5.
+  for (const std::size_t size : {5ull, 16ull}) {
+    SmallStreambuf b{"", size};
+    std::ostream os{&b};
+
+    for (const auto &x : xs)
+      lttoolbox::encode(os, x);
+
+    os.flush();
+    BOOST_CHECK(os);
+    BOOST_CHECK(std::equal(b.s.cbegin(), b.s.cend(), expected.cbegin(),
+                           expected.cend()));
+  }
+
+  SmallStreambuf b{{expected.data(), expected.size()}, 13ull};
+  std::istream is{&b};
+  std::vector<std::uint64_t> decoded(xs.size());
+
+  for (auto &x : decoded)
+    lttoolbox::decode(is, x);
+
+  BOOST_CHECK(is);
+  BOOST_CHECK(decoded == xs);
+
+  std::uint64_t x{0x2aull};
+  BOOST_CHECK(!lttoolbox::decode(is, x));
+  BOOST_CHECK_EQUAL(x, 0x2aull);
+
+  // A value too large for the type is extracted, as it always was.
+  std::istringstream narrow{std::string{'\x81', '\x00', '\x01'}};
+  std::uint8_t y{0x2au};
+  BOOST_CHECK(!lttoolbox::decode(narrow, y));
+  BOOST_CHECK_EQUAL(y, 0x2au);
+  narrow.clear();
+  BOOST_CHECK(lttoolbox::decode(narrow, y));
+  BOOST_CHECK_EQUAL(y, 0x01u);
+
+  // A tied stream is flushed first.
+  SmallStreambuf t{"", 16ull};
+  std::ostream tied{&t};
+  std::istringstream input{std::string{'\x01'}};
+  input.tie(&tied);
+  lttoolbox::encode(tied, xs[0]);
+  BOOST_CHECK(t.s.empty());
+  lttoolbox::decode(input, x);
+  BOOST_CHECK_EQUAL(x, 0x01ull);
+  BOOST_CHECK(std::equal(t.s.cbegin(), t.s.cend(), expected.cbegin(),
+                         expected.cbegin() + t.s.size()));
+  BOOST_CHECK(!t.s.empty());
+}
+
+BOOST_AUTO_TEST_CASE(buffer_truncated) {
+  const std::array<char, 3ull> s{{'\xe0', '\x20', '\x00'}};
+  std::uint64_t x{0x2aull};
+
+  for (std::size_t size{0ull}; size != s.size(); ++size)
+    BOOST_CHECK(lttoolbox::decode(s.data(), s.data() + size, x) == s.data());
+
+  BOOST_CHECK_EQUAL(x, 0x2aull);
+}
+
+BOOST_AUTO_TEST_CASE(buffer_sequence) {
+  const std::array<std::uint64_t, 5ull> xs{{0x7full, 0x80ull, 0x1f'ff'ffull,
+                                            0x01'00'00'00'00'00'00'00ull,
+                                            0x00ull}};
+  std::array<char, 9ull * xs.size()> s{};
+  char *last{s.data()};
+
+  for (const auto &x : xs)
+    last = lttoolbox::encode(last, x);
+
+  BOOST_CHECK_EQUAL(last - s.data(), 1 + 2 + 3 + 9 + 1);
+
+  const char *first{s.data()};
+
+  for (const auto &x : xs) {
+    std::uint64_t decoded{0ull};
+    const char *const next{lttoolbox::decode(first, last, decoded)};
+    BOOST_CHECK(next != first);
+    BOOST_CHECK_EQUAL(decoded, x);
+    first = next;
+  }
+
+  BOOST_CHECK(first == last);
+}
+
+BOOST_AUTO_TEST_CASE(buffer_round_trip) {
+  std::mt19937_64 engine{0x10ull};
+  std::vector<std::uint64_t> xs(4096ull);
+
+  for (auto &x : xs)
+    x = engine() >> (engine() % 64ull);
+
+  std::vector<char> s(9ull * xs.size());
+  char *last{s.data()};
+
+  for (const auto &x : xs)
+    last = lttoolbox::encode(last, x);
+
+  const char *first{s.data()};
+  std::istringstream is{{s.data(), static_cast<std::size_t>(last - first)}};
+
+  for (const auto &x : xs) {
+    std::uint64_t decoded{0ull};
+    first = lttoolbox::decode(first, last, decoded);
+    BOOST_CHECK_EQUAL(decoded, x);
+    lttoolbox::decode(is, decoded);
+    BOOST_CHECK_EQUAL(decoded, x);
+  }
+
+  BOOST_CHECK(first == last);
+}
+
+BOOST_AUTO_TEST_CASE(decode_n_round_trip) {
+  std::mt19937_64 engine{0x20ull};
+  std::vector<std::uint64_t> xs(4096ull);
+
+  for (auto &x : xs)
+    x = engine() >> (engine() % 64ull);
+
+  std::vector<char> s(9ull * xs.size());
+  char *last{s.data()};
+
+  for (const auto &x : xs)
+    last = lttoolbox::encode(last, x);
+
+  std::vector<std::uint64_t> decoded(xs.size());
+  BOOST_CHECK(lttoolbox::decode_n(s.data(), last, decoded.data(),
+                                  decoded.size()) == last);
+  BOOST_CHECK(decoded == xs);
+
+  decoded.assign(1ull, 0x2aull);
+  BOOST_CHECK(lttoolbox::decode_n(s.data(), last, decoded, xs.size()) ==
+              last);
+  BOOST_CHECK_EQUAL(decoded.size(), 1ull + xs.size());
+  BOOST_CHECK(std::equal(decoded.cbegin() + 1, decoded.cend(), xs.cbegin()));
+
+  // One value too many, so the last value is truncated.
+  decoded.assign(1ull, 0x2aull);
+  BOOST_CHECK(lttoolbox::decode_n(s.data(), last - 1, decoded, xs.size()) ==
+              s.data());
+  BOOST_CHECK_EQUAL(decoded.size(), 1ull);
+  BOOST_CHECK(lttoolbox::decode_n(s.data(), last, decoded, xs.size() + 1ull) ==
+              s.data());
+  BOOST_CHECK_EQUAL(decoded.size(), 1ull);
+}
+
+BOOST_AUTO_TEST_CASE(decode_n_uint32) {
+  const std::array<std::uint64_t, 3ull> xs{
+      {0x00ull, 0xff'ff'ff'ffull, 0x01'00'00'00'00ull}};
+  std::array<char, 9ull * xs.size()> s{};
+  char *last{s.data()};
+
+  for (const auto &x : xs)
+    last = lttoolbox::encode(last, x);
+
+  std::vector<std::uint32_t> decoded{};
+  const char *const next{lttoolbox::decode_n(s.data(), last, decoded, 2ull)};
+  BOOST_CHECK(next != s.data());
+  BOOST_CHECK(decoded == std::vector<std::uint32_t>({0x00u, 0xff'ff'ff'ffu}));
+
+  // The third value does not fit in 32 bits.
+  BOOST_CHECK(lttoolbox::decode_n(next, last, decoded, 1ull) == next);
+  BOOST_CHECK_EQUAL(decoded.size(), 2ull);
+}
+
+BOOST_AUTO_TEST_CASE(narrow_uint8) {
+  test_narrow(std::uint8_t{0x7fu}, std::array<char, 1ull>({'\x7f'}));
+  test_narrow(std::uint8_t{0x80u}, std::array<char, 2ull>({'\x80', '\x80'}));
+  test_narrow(std::uint8_t{0xffu}, std::array<char, 2ull>({'\x80', '\xff'}));
+}
+
+BOOST_AUTO_TEST_CASE(narrow_uint16) {
+  test_narrow(std::uint16_t{0x3f'ffu},
+              std::array<char, 2ull>({'\xbf', '\xff'}));
+  test_narrow(std::uint16_t{0x40'00u},
+              std::array<char, 3ull>({'\xc0', '\x40', '\x00'}));
+  test_narrow(std::uint16_t{0xff'ffu},
+              std::array<char, 3ull>({'\xc0', '\xff', '\xff'}));
+}
+
+BOOST_AUTO_TEST_CASE(narrow_uint32) {
+  test_narrow(std::uint32_t{0x0f'ff'ff'ffu},
+              std::array<char, 4ull>({'\xef', '\xff', '\xff', '\xff'}));
+  test_narrow(
+      std::uint32_t{0x10'00'00'00u},
+      std::array<char, 5ull>({'\xf0', '\x10', '\x00', '\x00', '\x00'}));
+  test_narrow(
+      std::uint32_t{0xff'ff'ff'ffu},
+      std::array<char, 5ull>({'\xf0', '\xff', '\xff', '\xff', '\xff'}));
+}
+
+BOOST_AUTO_TEST_CASE(narrow_signed) {
+  // Encode `x` with `encode_zigzag`, check that it is `s`, and then decode it
+  // with `decode_zigzag`.
+  const auto test = [](const auto x, const std::string &s) {
+    using T = typename std::decay<decltype(x)>::type;
+    char encoded[9ull];
+    const char *const last{lttoolbox::encode_zigzag(encoded, x)};
+    BOOST_CHECK(std::string(encoded, last - encoded) == s);
+
+    std::ostringstream os{};
+    lttoolbox::encode_zigzag(os, x);
+    BOOST_CHECK(os.str() == s);
+
+    T decoded{0};
+    BOOST_CHECK(lttoolbox::decode_zigzag(s.data(), s.data() + s.size(),
+                                         decoded) == s.data() + s.size());
+    BOOST_CHECK(decoded == x);
+
+    std::istringstream is{s};
+    decoded = 0;
+    BOOST_CHECK(lttoolbox::decode_zigzag(is, decoded));
+    BOOST_CHECK(decoded == x);
+  };
+
+  test(std::int8_t{-1}, "\x01");
+  test(std::int8_t{-0x80}, "\x80\xff");
+  test(std::int16_t{0x12'34}, "\xa4\x68");
+  test(std::int32_t{-0x7f'ff'ff'ff - 1}, "\xf0\xff\xff\xff\xff");
+
+  // A narrow value in too great a class is not decoded.
+  const std::string s{"\xc0\x40\x00"};
+  std::int8_t x{0x2a};
+  BOOST_CHECK(lttoolbox::decode_zigzag(s.data(), s.data() + s.size(), x) ==
+              s.data());
+  BOOST_CHECK_EQUAL(x, 0x2a);
+}
+
+BOOST_AUTO_TEST_CASE(plain_integers) {
+  // Every integer argument is encoded as the `std::uint64_t` that it converts
+  // to, as it was before there were overloads for other types.
+  std::ostringstream os{};
+  lttoolbox::encode(os, 5);
+  lttoolbox::encode(os, -1);
+  lttoolbox::encode(os, 0x12'34l);
+  BOOST_CHECK(os.str() == std::string("\x05\xff\xff\xff\xff\xff\xff"
+                                      "\xff\xff\xff\x92\x34",
+                                      12ull));
+
+  char s[9ull];
+  BOOST_CHECK(lttoolbox::encode(s, ~0ull) == s + 9);
+  BOOST_CHECK(lttoolbox::encode(s, static_cast<short>(0x80)) == s + 2);
+
+  std::istringstream is{os.str()};
+  std::uint64_t x{0ull};
+  BOOST_CHECK(lttoolbox::decode(is, x));
+  BOOST_CHECK_EQUAL(x, 5ull);
+  BOOST_CHECK(lttoolbox::decode(is, x));
+  BOOST_CHECK_EQUAL(x, ~0ull);
+}
+
+BOOST_AUTO_TEST_CASE(zigzag) {
+  BOOST_CHECK_EQUAL(lttoolbox::to_zigzag(std::int64_t{0}), 0ull);
+  BOOST_CHECK_EQUAL(lttoolbox::to_zigzag(std::int64_t{-1}), 1ull);
+  BOOST_CHECK_EQUAL(lttoolbox::to_zigzag(std::int64_t{1}), 2ull);
+  BOOST_CHECK_EQUAL(lttoolbox::to_zigzag(std::int64_t{-0x40}), 0x7full);
+  BOOST_CHECK_EQUAL(
+      lttoolbox::to_zigzag(std::numeric_limits<std::int64_t>::min()),
+      0xff'ff'ff'ff'ff'ff'ff'ffull);
+
+  for (const std::int64_t x :
+       {std::int64_t{-0x40}, std::int64_t{0x3f}, std::int64_t{-0x41},
+        std::numeric_limits<std::int64_t>::min(),
+        std::numeric_limits<std::int64_t>::max()}) {
+    char s[9ull];
+    const char *const last{lttoolbox::encode_zigzag(s, x)};
+    const int size{x == -0x41 ? 2 : x >= -0x40 && x <= 0x3f ? 1 : 9};
+    BOOST_CHECK_EQUAL(last - s, size);
+
+    std::int64_t decoded{0};
+    BOOST_CHECK(lttoolbox::decode_zigzag(s, last, decoded) == last);
+    BOOST_CHECK_EQUAL(decoded, x);
+
+    std::ostringstream os{};
+    lttoolbox::encode_zigzag(os, x);
+    std::istringstream is{os.str()};
+    decoded = 0;
+    BOOST_CHECK(lttoolbox::decode_zigzag(is, decoded));
+    BOOST_CHECK_EQUAL(decoded, x);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(floating_point) {
+  // Encode and decode `x` through a buffer and a stream, and then check that
+  // it is `size` bytes and that its bit pattern is unchanged.
+  const auto test = [](const auto x, const std::ptrdiff_t size) {
+    using T = typename std::decay<decltype(x)>::type;
+    char s[9ull];
+    const char *const last{lttoolbox::encode(s, x)};
+    BOOST_CHECK_EQUAL(last - s, size);
+
+    T decoded{-x};
+    BOOST_CHECK(lttoolbox::decode(s, last, decoded) == last);
+    BOOST_CHECK_EQUAL(std::memcmp(&decoded, &x, sizeof(x)), 0);
+
+    std::ostringstream os{};
+    lttoolbox::encode(os, x);
+    std::istringstream is{os.str()};
+    decoded = -x;
+    BOOST_CHECK(lttoolbox::decode(is, decoded));
+    BOOST_CHECK_EQUAL(std::memcmp(&decoded, &x, sizeof(x)), 0);
+  };
+
+  test(0.0, 1);
+  test(2.0, 1);
+  test(-2.0, 2);
+  test(1.0, 2);
+  test(-1.0, 2);
+  test(0.5, 2);
+  test(-0.0, 2);
+  test(3.0, 3);
+  test(0.1, 9);
+  test(std::numeric_limits<double>::infinity(), 2);
+  test(-std::numeric_limits<double>::denorm_min(), 9);
+  test(std::numeric_limits<double>::max(), 9);
+
+  test(0.0f, 1);
+  test(1.0f, 2);
+  test(-0.0f, 2);
+  test(0.1f, 5);
+  test(std::numeric_limits<float>::lowest(), 5);
+
+  // A NaN's payload is kept.
+  const std::uint64_t nan_bits{0x7f'f4'00'00'de'ad'be'efull};
+  double nan{0.0};
+  std::memcpy(&nan, &nan_bits, sizeof(nan));
+  test(nan, 9);
+  const std::uint32_t nan_bits_f{0xff'80'00'01u};
+  float nan_f{0.0f};
+  std::memcpy(&nan_f, &nan_bits_f, sizeof(nan_f));
+  test(nan_f, 4);
+
+  // A value too large for a `float` is rejected.
+  char s[9ull];
+  const char *const last{lttoolbox::encode(s, 0.1)};
+  float x{1.0f};
+  BOOST_CHECK(lttoolbox::decode(s, last, x) == s);
+  BOOST_CHECK_EQUAL(x, 1.0f);
+}
+
+BOOST_AUTO_TEST_CASE(record) {
+  struct Transition {
+    std::uint32_t input;
+    std::uint32_t output;
+    std::uint64_t target;
+    double weight;
+  };
+
+  // Each is the greatest size of the fields plus 8 bytes for the last one.
+  static_assert(
+      lttoolbox::get_record_capacity<std::uint32_t, std::uint32_t,
+                                     std::uint64_t, double>() == 36ull,
+      "");
+  static_assert(lttoolbox::get_record_capacity<std::uint8_t, float>() == 15ull,
+                "");
+
+  std::vector<Transition> ts{};
+  std::vector<char> expected{};
+
+  for (const auto &x : generate_symbols(0x50ull)) {
+    const Transition t{static_cast<std::uint32_t>(x & 0xff'ffu),
+                       static_cast<std::uint32_t>(x >> 48u), x,
+                       static_cast<double>(x % 7ull)};
+    ts.push_back(t);
+
+    char s[9ull * 4ull];
+    char *last{lttoolbox::encode(s, t.input)};
+    last = lttoolbox::encode(last, t.output);
+    last = lttoolbox::encode(last, t.target);
+    last = lttoolbox::encode(last, t.weight);
+    expected.insert(expected.cend(), s, last);
+  }
+
+  // Through a buffer, a stream, and a stream whose buffer is too small for a
+  // whole record, so that the slow paths are taken.
+  std::vector<char> s(lttoolbox::get_record_capacity<std::uint32_t,
+                                                     std::uint32_t,
+                                                     std::uint64_t, double>() *
+                      ts.size());
+  char *last{s.data()};
+  std::ostringstream os{};
+  SmallStreambuf small{"", 5ull};
+  std::ostream small_os{&small};
+
+  for (const auto &t : ts) {
+    const auto x = std::tie(t.input, t.output, t.target, t.weight);
+    last = lttoolbox::encode_record(last, x);
+    lttoolbox::encode_record(os, x);
+    lttoolbox::encode_record(small_os, x);
+  }
+
+  small_os.flush();
+  BOOST_CHECK(std::equal(s.cbegin(), s.cbegin() + (last - s.data()),
+                         expected.cbegin(), expected.cend()));
+  BOOST_CHECK(os.str() == std::string(expected.cbegin(), expected.cend()));
+  BOOST_CHECK(small.s == os.str());
+
+  const char *first{s.data()};
+  std::istringstream is{os.str()};
+  SmallStreambuf small_in{small.s, 7ull};
+  std::istream small_is{&small_in};
+
+  for (const auto &t : ts) {
+    Transition u{}, v{}, w{};
+    first = lttoolbox::decode_record(
+        first, last, std::tie(u.input, u.output, u.target, u.weight));
+    BOOST_CHECK(lttoolbox::decode_record(
+        is, std::tie(v.input, v.output, v.target, v.weight)));
+    BOOST_CHECK(lttoolbox::decode_record(
+        small_is, std::tie(w.input, w.output, w.target, w.weight)));
+
+    for (const auto &x : {u, v, w}) {
+      BOOST_CHECK_EQUAL(x.input, t.input);
+      BOOST_CHECK_EQUAL(x.output, t.output);
+      BOOST_CHECK_EQUAL(x.target, t.target);
+      BOOST_CHECK_EQUAL(x.weight, t.weight);
+    }
+  }
+
+  BOOST_CHECK(first == last);
+
+  // A truncated record, or a field too large for its type, leaves the fields
+  // unchanged.
+  std::tuple<std::uint8_t, std::uint64_t> x{0x2au, 0x2aull};
+  const std::string t{'\x01', '\x80'};
+  BOOST_CHECK(lttoolbox::decode_record(t.data(), t.data() + t.size(), x) ==
+              t.data());
+  std::istringstream truncated{t};
+  BOOST_CHECK(!lttoolbox::decode_record(truncated, x));
+  BOOST_CHECK(std::get<0>(x) == 0x2au && std::get<1>(x) == 0x2aull);
+
+  const std::string u{'\x81', '\x00', '\x01'};
+  BOOST_CHECK(lttoolbox::decode_record(u.data(), u.data() + u.size(), x) ==
+              u.data());
+  std::istringstream overflow{u};
+  BOOST_CHECK(!lttoolbox::decode_record(overflow, x));
+  BOOST_CHECK(std::get<0>(x) == 0x2au && std::get<1>(x) == 0x2aull);
+
+  const std::string v{'\x01', '\x05'};
+  BOOST_CHECK(lttoolbox::decode_record(v.data(), v.data() + v.size(), x) ==
+              v.data() + v.size());
+  BOOST_CHECK(std::get<0>(x) == 0x01u && std::get<1>(x) == 0x05ull);
+
+  // A schema that ends in a narrow field, for which `encode` may still write
+  // 9 bytes, through a buffer of exactly the capacity and through the local
+  // buffer of a stream whose put area is too small.
+  const std::tuple<std::uint8_t, float> y{0xffu, -1.5f};
+  std::vector<char> y_s(
+      lttoolbox::get_record_capacity<std::uint8_t, float>());
+  const char *const y_last{lttoolbox::encode_record(y_s.data(), y)};
+  SmallStreambuf small_y{"", 5ull};
+  std::ostream small_y_os{&small_y};
+  lttoolbox::encode_record(small_y_os, y);
+  small_y_os.flush();
+  BOOST_CHECK(small_y.s == std::string(y_s.data(), y_last - y_s.data()));
+  std::tuple<std::uint8_t, float> z{};
+  BOOST_CHECK(lttoolbox::decode_record(y_s.data(), y_last, z) == y_last);
+  BOOST_CHECK(z == y);
+}
+
+BOOST_AUTO_TEST_CASE(string_codec) {
+  const std::vector<std::wstring> xs{
+      L"", L"<n>", L"<vblex>", L"a", L"long ASCII run of symbols",
+      L"\u00e9t\u00e9", L"ascii then \u4e2d\u6587 then ascii again",
+      L"\U0001f600", std::wstring(300ull, L'x')};
+  std::vector<char> s(9ull);
+  char *last{s.data()};
+
+  for (const auto &x : xs) {
+    const std::size_t offset = last - s.data();
+    s.resize(offset + lttoolbox::get_string_capacity<wchar_t>(x.size()));
+    last = lttoolbox::encode_string(s.data() + offset, x.data(), x.size());
+  }
+
+  s.resize(last - s.data());
+
+  // A run of ASCII characters is encoded as itself.
+  BOOST_CHECK(std::string(s.data(), s.data() + 5) ==
+              std::string("\0\3<n>", 5ull));
+
+  std::ostringstream os{};
+
+  for (const auto &x : xs)
+    lttoolbox::encode_string(os, x);
+
+  BOOST_CHECK(os.str() == std::string(s.cbegin(), s.cend()));
+
+  {
+    const char *first{s.data()};
+    std::istringstream is{os.str()};
+
+    for (const auto &x : xs) {
+      std::wstring y{L"?"};
+      const char *const next{
+          lttoolbox::decode_string(first, s.data() + s.size(), y)};
+      BOOST_CHECK(next != first || x.empty());
+      BOOST_CHECK(y == x);
+      first = next;
+
+      BOOST_CHECK(lttoolbox::decode_string(is, y));
+      BOOST_CHECK(y == x);
+    }
+
+    BOOST_CHECK(first == s.data() + s.size());
+  }
+
+  lttoolbox::StringTable<wchar_t> table{};
+  table.reserve(xs.size(), 0x200ull);
+  BOOST_CHECK(table.empty());
+  BOOST_CHECK(table.decode(s.data(), s.data() + s.size(), xs.size()) ==
+              s.data() + s.size());
+  BOOST_REQUIRE_EQUAL(table.size(), xs.size());
+
+  for (std::size_t k{0ull}; k != xs.size(); ++k) {
+    BOOST_CHECK_EQUAL(table.length(k), xs[k].size());
+    BOOST_CHECK(table.string(k) == xs[k]);
+    BOOST_CHECK(std::wstring{table.data(k)} == xs[k]);
+  }
+
+  // Truncated strings leave the table as it was.
+  for (std::size_t size{0ull}; size != s.size(); ++size) {
+    BOOST_CHECK(table.decode(s.data(), s.data() + size, xs.size()) ==
+                s.data());
+    BOOST_CHECK_EQUAL(table.size(), xs.size());
+
+    std::wstring y{};
+    std::istringstream is{std::string(s.data(), s.data() + size)};
+
+    for (std::size_t k{0ull}; k != xs.size(); ++k)
+      lttoolbox::decode_string(is, y);
+
+    BOOST_CHECK(!is);
+  }
+
+  // Characters greater than 0x7f are not sign-extended, and a character too
+  // large for `char` is rejected.
+  const std::string t{"\xe9t\xe9"};
+  std::ostringstream narrow_os{};
+  lttoolbox::encode_string(narrow_os, t);
+  const std::string narrow{narrow_os.str()};
+  BOOST_CHECK(narrow == std::string("\3\x80\xe9t\x80\xe9"));
+  std::string u{};
+  BOOST_CHECK(lttoolbox::decode_string(narrow.data(),
+                                       narrow.data() + narrow.size(),
+                                       u) == narrow.data() + narrow.size());
+  BOOST_CHECK(u == t);
+
+  // The length takes 3 bytes, and the last character may be encoded with 9
+  // bytes written, all within the capacity.
+  const std::string v(16'384ull, '\xe9');
+  std::vector<char> v_s(lttoolbox::get_string_capacity<char>(v.size()));
+  const char *const v_last{
+      lttoolbox::encode_string(v_s.data(), v.data(), v.size())};
+  BOOST_CHECK_EQUAL(v_last - v_s.data(), 3 + 2 * 16'384);
+  std::ostringstream v_os{};
+  lttoolbox::encode_string(v_os, v);
+  BOOST_CHECK(v_os.str() == std::string(v_s.data(), v_last - v_s.data()));
+  BOOST_CHECK(lttoolbox::decode_string(v_s.data(), v_last, u) == v_last);
+  BOOST_CHECK(u == v);
+
+  const std::string wide{os.str()};
+
+  lttoolbox::StringTable<char> narrow_table{};
+  const char *const first{wide.data()};
+  const char *const wide_last{first + wide.size()};
+  BOOST_CHECK(narrow_table.decode(first, wide_last, 5ull) != first);
+  BOOST_CHECK(narrow_table.decode(first, wide_last, xs.size()) == first);
+  BOOST_CHECK_EQUAL(narrow_table.size(), 5ull);
+  BOOST_CHECK(narrow_table.string(2ull) == "<vblex>");
+}
+
+BOOST_AUTO_TEST_CASE(decode_n_signed) {
+  std::vector<std::int64_t> xs{};
+  std::vector<std::int32_t> ys{};
+
+  for (const auto &x : generate_symbols(0x40ull)) {
+    xs.push_back(x & 1ull ? -static_cast<std::int64_t>(x) : x);
+
+    if (xs.back() >= std::numeric_limits<std::int32_t>::min() &&
+        xs.back() <= std::numeric_limits<std::int32_t>::max())
+      ys.push_back(xs.back());
+  }
+
+  std::vector<char> s(9ull * xs.size());
+  const char *last{
+      lttoolbox::encode_n_zigzag(s.data(), xs.data(), xs.size())};
+  std::vector<std::int64_t> decoded{};
+  BOOST_CHECK(lttoolbox::decode_n_zigzag(s.data(), last, decoded,
+                                         xs.size()) == last);
+  BOOST_CHECK(decoded == xs);
+
+  // Some of the values do not fit in 32 bits.
+  std::vector<std::int32_t> narrow{};
+  BOOST_CHECK(lttoolbox::decode_n_zigzag(s.data(), last, narrow,
+                                         xs.size()) == s.data());
+  BOOST_CHECK(narrow.empty());
+
+  char *t{s.data()};
+
+  for (const auto &y : ys)
+    t = lttoolbox::encode_zigzag(t, y);
+
+  last = t;
+  BOOST_CHECK(lttoolbox::decode_n_zigzag(s.data(), last, narrow,
+                                         ys.size()) == last);
+  BOOST_CHECK(narrow == ys);
+}
+
+BOOST_AUTO_TEST_CASE(narrow_overflow) {
+  // 0x100 is in the 1st class but does not fit in 8 bits, and 0x4000 is in
+  // the 2nd class, which no 8-bit value is in.
+  const std::array<char, 2ull> s{{'\x81', '\x00'}};
+  const std::array<char, 3ull> t{{'\xc0', '\x40', '\x00'}};
+  std::uint8_t x{0x2au};
+  BOOST_CHECK(lttoolbox::decode(s.data(), s.data() + s.size(), x) ==
+              s.data());
+  BOOST_CHECK(lttoolbox::decode(t.data(), t.data() + t.size(), x) ==
+              t.data());
+  BOOST_CHECK_EQUAL(x, 0x2au);
+
+  std::istringstream is{{t.data(), t.size()}};
+  BOOST_CHECK(!lttoolbox::decode(is, x));
+  BOOST_CHECK_EQUAL(x, 0x2au);
+
+  // The greatest class of a 32-bit value is the 4th.
+  const std::array<char, 6ull> u{{'\xf8', '\x00', '\x00', '\x00', '\x00',
+                                  '\x00'}};
+  std::uint32_t y{0x2au};
+  BOOST_CHECK(lttoolbox::decode(u.data(), u.data() + u.size(), y) ==
+              u.data());
+  BOOST_CHECK_EQUAL(y, 0x2au);
+}
+
+BOOST_AUTO_TEST_CASE(decode_n_symbols) {
+  const std::vector<std::uint64_t> xs{generate_symbols(0x30ull)};
+  std::vector<char> s(9ull * xs.size());
+  char *last{s.data()};
+
+  for (const auto &x : xs)
+    last = lttoolbox::encode(last, x);
+
+  // Decode different numbers of values so that the scalar tail starts in
+  // different places.
+  for (std::size_t n{xs.size() - 40ull}; n != xs.size() + 1ull; ++n) {
+    std::vector<std::uint64_t> decoded(n);
+    const char *const next{
+        lttoolbox::decode_n(s.data(), last, decoded.data(), n)};
+    BOOST_CHECK(std::equal(decoded.cbegin(), decoded.cend(), xs.cbegin()));
+
+    std::uint64_t x{0ull};
+    const char *first{s.data()};
+
+    for (std::size_t i{0ull}; i != n; ++i)
+      first = lttoolbox::decode(first, last, x);
+
+    BOOST_CHECK(next == first);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(kernels) {
+  const std::vector<std::uint64_t> xs{generate_symbols(0x40ull)};
+  std::vector<char> expected(9ull * xs.size());
+  char *expected_last{expected.data()};
+
+  for (const auto &x : xs)
+    expected_last = lttoolbox::encode(expected_last, x);
+
+  const auto kernels = get_kernels();
+
+  for (const auto kernel : kernels)
+    BOOST_CHECK(lttoolbox::is_supported(kernel));
+
+  for (std::size_t i{0ull}; i != lttoolbox::kernel_count; ++i) {
+    const auto k = static_cast<lttoolbox::Kernel>(i);
+
+    if (!lttoolbox::set_kernel(k)) {
+      BOOST_CHECK(!lttoolbox::is_supported(k));
+      continue;
+    }
+
+    BOOST_TEST_CHECKPOINT(lttoolbox::get_name(k));
+    std::vector<char> s(9ull * xs.size());
+    const char *const last{
+        lttoolbox::encode_n(s.data(), xs.data(), xs.size())};
+    BOOST_CHECK(std::equal<const char *>(s.data(), last, expected.data(),
+                                         expected_last));
+
+    std::vector<std::uint64_t> decoded(xs.size());
+    BOOST_CHECK(lttoolbox::decode_n(expected.data(), expected_last,
+                                    decoded.data(),
+                                    decoded.size()) == expected_last);
+    BOOST_CHECK(decoded == xs);
+  }
+
+  // Setting the kernel of one operation leaves the others alone.
+  BOOST_CHECK(lttoolbox::set_kernel(lttoolbox::Kernel::scalar));
+  BOOST_CHECK(lttoolbox::set_kernel(lttoolbox::Operation::encode,
+                                    kernels.back()));
+  BOOST_CHECK(lttoolbox::get_kernel(lttoolbox::Operation::decode) ==
+              lttoolbox::Kernel::scalar);
+  BOOST_CHECK(lttoolbox::get_kernel(lttoolbox::Operation::encode) ==
+              kernels.back());
+  set_kernels(kernels);
+}
+
+BOOST_AUTO_TEST_CASE(decode_count) {
+  // A count of 3 is followed by 3 bytes, but a count of 4 is malformed.
+  const std::string s{"\x03\x01\x02\x03"};
+  std::uint64_t n{0x2aull};
+  BOOST_CHECK(lttoolbox::decode_count(s.data(), s.data() + s.size(), n) ==
+              s.data() + 1);
+  BOOST_CHECK_EQUAL(n, 3ull);
+  n = 0x2aull;
+  BOOST_CHECK(lttoolbox::decode_count(s.data(), s.data() + 3, n) == s.data());
+  BOOST_CHECK_EQUAL(n, 0x2aull);
+
+  const std::string t{"\xff\xff\xff\xff\xff\xff\xff\xff\xff"};
+  BOOST_CHECK(lttoolbox::decode_count(t.data(), t.data() + t.size(), n) ==
+              t.data());
+}
+
+BOOST_AUTO_TEST_CASE(count_values) {
+  const std::vector<std::uint64_t> xs{generate_symbols(0xc0ull)};
+  std::vector<char> s(9ull * xs.size());
+  char *const last{lttoolbox::encode_n(s.data(), xs.data(), xs.size())};
+  const auto kernels = get_kernels();
+
+  for (std::size_t i{0ull}; i != lttoolbox::kernel_count; ++i) {
+    const auto k = static_cast<lttoolbox::Kernel>(i);
+
+    if (!lttoolbox::set_kernel(k))
+      continue;
+
+    BOOST_TEST_CHECKPOINT(lttoolbox::get_name(k));
+    BOOST_CHECK_EQUAL(lttoolbox::count_values(s.data(), last), xs.size());
+    BOOST_CHECK(lttoolbox::validate(s.data(), last) == last);
+
+    // Truncate the last value, which is 9 bytes.
+    *last = '\xff';
+    BOOST_CHECK_EQUAL(lttoolbox::count_values(s.data(), last + 1),
+                      xs.size());
+    BOOST_CHECK(lttoolbox::validate(s.data(), last + 1) == last);
+
+    // Compare each prefix that ends in the last 64 bytes with decoding.
+    for (const char *t_last{last - 64}; t_last != last; ++t_last) {
+      const char *t{s.data()};
+      std::size_t n{0ull};
+      std::uint64_t x{0ull};
+
+      for (const char *next; (next = lttoolbox::decode(t, t_last, x)) != t;
+           t = next)
+        ++n;
+
+      BOOST_CHECK(lttoolbox::validate(s.data(), t_last) == t);
+      BOOST_CHECK_EQUAL(lttoolbox::count_values(s.data(), t_last), n);
+    }
+  }
+
+  set_kernels(kernels);
+}
+
+BOOST_AUTO_TEST_CASE(group_varint) {
+  {
+    const std::uint64_t xs[]{0x01ull, 0x12'34ull, 0x12'34'56ull,
+                             0x12'34'56'78'9aull, 0xffull};
+    char s[lttoolbox::get_group_capacity(5ull)];
+    const char *const last{lttoolbox::encode_group(s, xs, 5ull)};
+    const std::string expected{
+        '\x05', '\xe4', '\x00', '\x01', '\x34', '\x12', '\x56', '\x34',
+        '\x12', '\x00', '\x9a', '\x78', '\x56', '\x34', '\x12', '\x00',
+        '\x00', '\x00', '\xff'};
+    BOOST_CHECK(std::string(static_cast<const char *>(s), last) == expected);
+  }
+
+  const std::vector<std::uint64_t> xs{generate_symbols(0xd0ull)};
+  std::vector<char> s(lttoolbox::get_group_capacity(xs.size()));
+  const char *const last{lttoolbox::encode_group(s.data(), xs.data(),
+                                                 xs.size())};
+  const auto kernels = get_kernels();
+
+  for (std::size_t i{0ull}; i != lttoolbox::kernel_count; ++i) {
+    const auto k = static_cast<lttoolbox::Kernel>(i);
+
+    if (!lttoolbox::set_kernel(k))
+      continue;
+
+    BOOST_TEST_CHECKPOINT(lttoolbox::get_name(k));
+    std::vector<std::uint64_t> decoded{0x2aull};
+    BOOST_CHECK(lttoolbox::decode_group(s.data(), last, decoded) == last);
+    BOOST_CHECK_EQUAL(decoded.front(), 0x2aull);
+    BOOST_CHECK(std::equal(decoded.cbegin() + 1, decoded.cend(), xs.cbegin(),
+                           xs.cend()));
+
+    // Every value of a short block near the end of its bytes.
+    for (std::size_t n{0ull}; n != 9ull; ++n) {
+      char t[lttoolbox::get_group_capacity(8ull)];
+      const std::size_t offset{xs.size() - 8ull};
+      const char *const t_last{
+          lttoolbox::encode_group(t, xs.data() + offset, n)};
+      decoded.clear();
+      BOOST_CHECK(lttoolbox::decode_group(t, t_last, decoded) == t_last);
+      BOOST_CHECK(std::equal(decoded.cbegin(), decoded.cend(),
+                             xs.cbegin() + offset, xs.cbegin() + offset + n));
+    }
+
+    for (const char *t_last{last - 64}; t_last != last; ++t_last) {
+      decoded.clear();
+      BOOST_CHECK(lttoolbox::decode_group(s.data(), t_last, decoded) ==
+                  s.data());
+      BOOST_CHECK(decoded.empty());
+    }
+
+    // A block with an unused code other than 0 in its last control byte.
+    for (std::size_t n{1ull}; n != 4ull; ++n) {
+      for (unsigned int code{1u}; code != 4u; ++code) {
+        char t[lttoolbox::get_group_capacity(8ull)]{};
+        const char *const t_last{
+            lttoolbox::encode_group(t, xs.data(), 4ull + n)};
+        t[2] = static_cast<char>(static_cast<unsigned char>(t[2]) |
+                                 code << (2ull * n));
+        decoded.clear();
+        BOOST_CHECK(lttoolbox::decode_group(t, t_last + 8, decoded) == t);
+        BOOST_CHECK(decoded.empty());
+
+        std::istringstream is{std::string(static_cast<const char *>(t),
+                                         t_last + 8)};
+        std::ostringstream os{};
+        BOOST_CHECK(!lttoolbox::transcode_from_group(is, os));
+      }
+    }
+  }
+
+  set_kernels(kernels);
+}
+
+BOOST_AUTO_TEST_CASE(transcode_group) {
+  std::vector<std::uint64_t> xs{};
+
+  for (std::uint64_t seed{0xe0ull}; seed != 0xe2ull; ++seed) {
+    const std::vector<std::uint64_t> ys{generate_symbols(seed)};
+    xs.insert(xs.cend(), ys.cbegin(), ys.cend());
+  }
+
+  BOOST_REQUIRE_GT(xs.size(), 2ull * lttoolbox::group_block_size);
+  std::string encoded{};
+  lttoolbox::EncodeWriter{encoded}.encode_range(xs.data(),
+                                                xs.data() + xs.size());
+
+  std::istringstream is{encoded};
+  std::ostringstream group{};
+  BOOST_CHECK(lttoolbox::transcode_to_group(is, group));
+
+  std::vector<std::uint64_t> decoded{};
+  const std::string g{group.str()};
+  const char *first{g.data()};
+
+  for (const char *next;
+       (next = lttoolbox::decode_group(first, g.data() + g.size(),
+                                       decoded)) != first;
+       first = next)
+    ;
+
+  BOOST_CHECK(first == g.data() + g.size());
+  BOOST_CHECK(decoded == xs);
+
+  std::istringstream group_is{g};
+  std::ostringstream os{};
+  BOOST_CHECK(lttoolbox::transcode_from_group(group_is, os));
+  BOOST_CHECK(os.str() == encoded);
+
+  // A truncated value or block is reported.
+  std::istringstream truncated{encoded.substr(0ull, encoded.size() - 1ull)};
+  std::ostringstream ignored{};
+  BOOST_CHECK(!lttoolbox::transcode_to_group(truncated, ignored) ||
+              lttoolbox::encoded_size(xs.back()) == 1ull);
+
+  std::istringstream truncated_group{g.substr(0ull, g.size() - 1ull)};
+  BOOST_CHECK(!lttoolbox::transcode_from_group(truncated_group, ignored));
+
+  // So is a block too large to transcode in constant memory.
+  std::vector<char> large(
+      lttoolbox::get_group_capacity(lttoolbox::group_block_size + 1ull));
+  large.resize(lttoolbox::encode_group(large.data(), xs.data(),
+                                       lttoolbox::group_block_size + 1ull) -
+               large.data());
+  std::istringstream large_is{std::string(large.cbegin(), large.cend())};
+  BOOST_CHECK(!lttoolbox::transcode_from_group(large_is, ignored));
+}
+
+BOOST_AUTO_TEST_CASE(bit_packed) {
+  const auto round_trip = [](const std::vector<std::uint64_t> &xs)
+      -> std::vector<char> {
+    std::vector<char> s(lttoolbox::get_bit_packed_capacity(xs.size()));
+    s.resize(lttoolbox::encode_bit_packed(s.data(), xs.data(), xs.size()) -
+             s.data());
+
+    std::vector<std::uint64_t> decoded{0x2aull};
+    BOOST_CHECK(lttoolbox::decode_bit_packed(s.data(), s.data() + s.size(),
+                                             decoded) ==
+                s.data() + s.size());
+    BOOST_CHECK_EQUAL(decoded.front(), 0x2aull);
+    BOOST_CHECK(std::equal(decoded.cbegin() + 1, decoded.cend(), xs.cbegin(),
+                           xs.cend()));
+    return s;
+  };
+
+  std::mt19937_64 engine{0xf0ull};
+
+  // Each width, with the minimum and maximum of the first block at its start.
+  for (unsigned int width{0u}; width <= 64u; ++width) {
+    BOOST_TEST_CHECKPOINT(width);
+    const std::uint64_t mask{width == 64u ? ~0ull : (1ull << width) - 1ull};
+    const std::uint64_t minimum{width == 64u ? 0ull : engine() >> width};
+    std::vector<std::uint64_t> xs(2ull + engine() % 300ull);
+
+    for (auto &x : xs)
+      x = minimum + (engine() & mask);
+
+    xs[0ull] = minimum;
+    xs[1ull] = minimum + mask;
+    const std::vector<char> s{round_trip(xs)};
+
+    // Packing is chosen when it is no larger.
+    const std::size_t k{
+        std::min(xs.size(), lttoolbox::bit_packed_block_size)};
+    const std::size_t header{lttoolbox::encoded_size(xs.size())};
+    const bool packed{
+        lttoolbox::encoded_size(minimum) + (k * width + 7ull) / 8ull <=
+        lttoolbox::encoded_size(xs.data(), xs.data() + k)};
+    BOOST_CHECK_EQUAL(static_cast<unsigned char>(s[header]),
+                      packed ? width : 0xffu);
+  }
+
+  // State numbers, which are all in the 2nd class, are packed in 21 bits or
+  // fewer rather than 3 bytes each.
+  std::vector<std::uint64_t> states(1000ull);
+
+  for (auto &x : states)
+    x = 0x40'00ull + engine() % (0x20'00'00ull - 0x40'00ull);
+
+  const std::vector<char> s{round_trip(states)};
+  BOOST_CHECK_LT(s.size(), 21ull * states.size() / 8ull + 64ull);
+
+  round_trip({});
+  round_trip({0x2aull});
+  round_trip(std::vector<std::uint64_t>(1000ull, 0x12'34'56ull));
+  round_trip(generate_symbols(0xf1ull));
+
+  for (std::size_t size{0ull}; size != s.size(); ++size) {
+    std::vector<std::uint64_t> decoded{};
+    BOOST_CHECK(lttoolbox::decode_bit_packed(s.data(), s.data() + size,
+                                             decoded) == s.data());
+    BOOST_CHECK(decoded.empty());
+  }
+
+  const std::string t{'\x01', '\x41', '\x00'};
+  std::vector<std::uint64_t> decoded{};
+  BOOST_CHECK(lttoolbox::decode_bit_packed(t.data(), t.data() + t.size(),
+                                           decoded) == t.data());
+}
+
+BOOST_AUTO_TEST_CASE(decode_n_padded_round_trip) {
+  std::mt19937_64 engine{0x50ull};
+  std::vector<std::uint64_t> xs(4096ull);
+
+  for (auto &x : xs)
+    x = engine() >> (engine() % 64ull);
+
+  std::vector<char> s(9ull * xs.size());
+  const char *const last{lttoolbox::encode_n(s.data(), xs.data(), xs.size())};
+  const lttoolbox::PaddedBuffer padded{s.data(), last};
+  BOOST_CHECK_EQUAL(padded.size(), static_cast<std::size_t>(last - s.data()));
+
+  std::vector<std::uint64_t> decoded(xs.size());
+  BOOST_CHECK(lttoolbox::decode_n_padded(padded, decoded.data(),
+                                         decoded.size()) == padded.end());
+  BOOST_CHECK(decoded == xs);
+
+  // The last value is truncated, although the padding after it is readable.
+  BOOST_CHECK(lttoolbox::decode_n_padded(padded.begin(), padded.end() - 1,
+                                         decoded.data(),
+                                         decoded.size()) == padded.begin());
+
+  // There is one value too few.
+  BOOST_CHECK(lttoolbox::decode_n_padded(padded, decoded.data(),
+                                         decoded.size() + 1ull) ==
+              padded.begin());
+}
+
+BOOST_AUTO_TEST_CASE(read_padded) {
+  const std::string s{
+      "\x7f\x80\x80\xff\x01\x02\x03\x04\x05\x06\x07\x08"};
+  std::istringstream is{s};
+  const lttoolbox::PaddedBuffer padded{lttoolbox::read_padded(is)};
+  BOOST_CHECK(std::equal(padded.begin(), padded.end(), s.cbegin(), s.cend()));
+  BOOST_CHECK(std::all_of(padded.end(),
+                          padded.end() + lttoolbox::PaddedBuffer::padding,
+                          [](const char c) { return c == '\0'; }));
+
+  std::array<std::uint64_t, 3ull> decoded{};
+  BOOST_CHECK(lttoolbox::decode_n_padded(padded, decoded.data(),
+                                         decoded.size()) == padded.end());
+  const std::array<std::uint64_t, 3ull> xs{
+      {0x7full, 0x80ull, 0x01'02'03'04'05'06'07'08ull}};
+  BOOST_CHECK(decoded == xs);
+}
+
+BOOST_AUTO_TEST_CASE(encode_writer) {
+  const std::vector<std::uint64_t> xs{generate_symbols(0x60ull)};
+  std::ostringstream expected_os{};
+
+  for (const auto &x : xs)
+    lttoolbox::encode(expected_os, x);
+
+  const std::string expected{expected_os.str()};
+  const std::size_t half{xs.size() / 2ull};
+
+  // Encode half of the values one by one and the rest all at once.
+  const auto write = [&](lttoolbox::EncodeWriter &writer) {
+    for (std::size_t i{0ull}; i != half; ++i)
+      writer.encode(xs[i]);
+
+    writer.encode_range(xs.data() + half, xs.data() + xs.size());
+    BOOST_CHECK(writer.flush());
+  };
+
+  {
+    std::ostringstream os{};
+    lttoolbox::EncodeWriter writer{os};
+    write(writer);
+    BOOST_CHECK(os.str() == expected);
+  }
+
+  {
+    std::string s{"ab"};
+    lttoolbox::EncodeWriter writer{s};
+    write(writer);
+    BOOST_CHECK(s == "ab" + expected);
+  }
+
+  {
+    std::vector<char> s{};
+
+    {
+      lttoolbox::EncodeWriter writer{s};
+      writer.encode(0x80ull);
+    }
+
+    BOOST_CHECK(s == std::vector<char>({'\x80', '\x80'}));
+    lttoolbox::EncodeWriter writer{s};
+    write(writer);
+    BOOST_CHECK(std::equal(s.cbegin() + 2, s.cend(), expected.cbegin(),
+                           expected.cend()));
+  }
+
+  {
+    std::FILE *const file{std::tmpfile()};
+    BOOST_REQUIRE(file != nullptr);
+
+    {
+      lttoolbox::EncodeWriter writer{fileno(file)};
+      write(writer);
+    }
+
+    std::rewind(file);
+    std::string s(expected.size() + 1ull, '\0');
+    s.resize(std::fread(&s[0ull], 1ull, s.size(), file));
+    std::fclose(file);
+    BOOST_CHECK(s == expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(decode_iterator) {
+  // Enough values that a stream is read more than one buffer at a time.
+  std::vector<std::uint64_t> xs{};
+
+  for (std::uint64_t seed{0x110ull}; seed != 0x114ull; ++seed) {
+    const std::vector<std::uint64_t> ys{generate_symbols(seed)};
+    xs.insert(xs.cend(), ys.cbegin(), ys.cend());
+  }
+
+  std::string s{};
+
+  {
+    lttoolbox::EncodeWriter writer{s};
+    std::copy(xs.cbegin(), xs.cend(), lttoolbox::EncodeOutputIterator{writer});
+  }
+
+  BOOST_REQUIRE_GT(s.size(), 2ull * lttoolbox::DecodedRange::buffer_size);
+  std::vector<char> expected(9ull * xs.size());
+  expected.resize(lttoolbox::encode_n(expected.data(), xs.data(), xs.size()) -
+                  expected.data());
+  BOOST_CHECK(std::equal(s.cbegin(), s.cend(), expected.cbegin(),
+                         expected.cend()));
+
+  const auto check = [&](lttoolbox::DecodedRange &range,
+                         const std::size_t size) {
+    const std::vector<std::uint64_t> decoded(range.begin(), range.end());
+    BOOST_CHECK(std::equal(decoded.cbegin(), decoded.cend(), xs.cbegin(),
+                           xs.cbegin() + size));
+    BOOST_CHECK_EQUAL(range.good(), size == xs.size());
+  };
+
+  {
+    lttoolbox::DecodedRange range{s.data(), s.data() + s.size()};
+    check(range, xs.size());
+  }
+
+  {
+    std::istringstream is{s};
+    lttoolbox::DecodedRange range{is};
+    check(range, xs.size());
+  }
+
+  {
+    std::FILE *const file{std::tmpfile()};
+    BOOST_REQUIRE(file != nullptr);
+    BOOST_REQUIRE_EQUAL(std::fwrite(s.data(), 1ull, s.size(), file), s.size());
+    std::rewind(file);
+    lttoolbox::DecodedRange range{fileno(file)};
+    check(range, xs.size());
+    std::fclose(file);
+  }
+
+  // The last value is truncated.
+  s.pop_back();
+
+  {
+    lttoolbox::DecodedRange range{s.data(), s.data() + s.size()};
+    check(range, xs.size() - 1ull);
+  }
+
+  {
+    std::istringstream is{s};
+    lttoolbox::DecodedRange range{is};
+    check(range, xs.size() - 1ull);
+  }
+
+  {
+    std::istringstream is{""};
+    lttoolbox::DecodedRange range{is};
+    BOOST_CHECK(range.begin() == range.end());
+    BOOST_CHECK(range.good());
+  }
+
+  const std::string t{'\x80', '\x80', '\x01'};
+  lttoolbox::DecodedRange range{t.data(), t.data() + t.size()};
+  BOOST_CHECK_EQUAL(std::accumulate(range.begin(), range.end(), 0ull),
+                    0x81ull);
+}
+
+BOOST_AUTO_TEST_CASE(mapped_decoder) {
+  const std::vector<std::uint64_t> xs{generate_symbols(0x70ull)};
+  char path[]{"/tmp/testio.XXXXXX"};
+  const int fd{mkstemp(path)};
+  BOOST_REQUIRE(fd != -1);
+
+  {
+    lttoolbox::EncodeWriter writer{fd};
+    writer.encode_range(xs.data(), xs.data() + xs.size());
+  }
+
+  close(fd);
+
+  {
+    lttoolbox::MappedDecoder decoder{path};
+    BOOST_REQUIRE(decoder.is_open());
+
+    std::uint64_t x{0ull};
+    BOOST_CHECK(decoder.decode(x));
+    BOOST_CHECK_EQUAL(x, xs.front());
+
+    std::vector<std::uint64_t> decoded(xs.size() - 1ull);
+    BOOST_CHECK(decoder.decode_n(decoded.data(), decoded.size()));
+    BOOST_CHECK(std::equal(decoded.cbegin(), decoded.cend(),
+                           xs.cbegin() + 1));
+    BOOST_CHECK_EQUAL(decoder.tell(), decoder.size());
+    BOOST_CHECK(!decoder.decode(x));
+    BOOST_CHECK(!decoder.decode_n(decoded.data(), 1ull));
+
+    BOOST_CHECK(decoder.seek(0ull));
+    BOOST_CHECK(decoder.decode(x));
+    BOOST_CHECK_EQUAL(x, xs.front());
+
+    // The end of the file can be sought to, but nothing past it.
+    BOOST_CHECK(decoder.seek(decoder.size()));
+    BOOST_CHECK(!decoder.decode(x));
+    BOOST_CHECK(!decoder.seek(decoder.size() + 1ull));
+    BOOST_CHECK(!decoder.seek(100'000'000ull));
+    BOOST_CHECK_EQUAL(decoder.tell(), decoder.size());
+    BOOST_CHECK(decoder.seek(0ull));
+
+    const lttoolbox::BlockIndex index{decoder.begin(), decoder.end(), 16ull};
+    BOOST_CHECK(decoder.seek_to_value(index, 100ull));
+    BOOST_CHECK(decoder.decode(x));
+    BOOST_CHECK_EQUAL(x, xs[100ull]);
+    BOOST_CHECK(!decoder.seek_to_value(index, xs.size() + 1ull));
+    BOOST_CHECK(decoder.decode(x));
+    BOOST_CHECK_EQUAL(x, xs[101ull]);
+  }
+
+  // An empty file is not mapped, and only its start can be sought to.
+  BOOST_REQUIRE(truncate(path, 0) == 0);
+
+  {
+    lttoolbox::MappedDecoder decoder{path};
+    BOOST_REQUIRE(decoder.is_open());
+    std::uint64_t x{0ull};
+    BOOST_CHECK_EQUAL(decoder.size(), 0ull);
+    BOOST_CHECK(!decoder.seek(1ull));
+    BOOST_CHECK(decoder.seek(0ull));
+    BOOST_CHECK(!decoder.decode(x));
+  }
+
+  std::remove(path);
+  BOOST_CHECK(!lttoolbox::MappedDecoder{path}.is_open());
+}
+
+BOOST_AUTO_TEST_CASE(block_index) {
+  const std::vector<std::uint64_t> xs{generate_symbols(0x90ull)};
+  std::vector<char> s(9ull * xs.size());
+  const char *const last{lttoolbox::encode_n(s.data(), xs.data(), xs.size())};
+
+  for (const std::size_t block_size : {1ull, 7ull, 64ull}) {
+    const lttoolbox::BlockIndex index{s.data(), last, block_size};
+    BOOST_CHECK_EQUAL(index.size(), xs.size());
+
+    for (std::size_t k{0ull}; k < xs.size(); k += 37ull) {
+      const char *const first{
+          lttoolbox::seek_to_value(s.data(), last, index, k)};
+      std::uint64_t x{0ull};
+      BOOST_REQUIRE(first != nullptr);
+      BOOST_CHECK(lttoolbox::decode(first, last, x) != first);
+      BOOST_CHECK_EQUAL(x, xs[k]);
+    }
+
+    BOOST_CHECK(lttoolbox::seek_to_value(s.data(), last, index, xs.size()) ==
+                last);
+    BOOST_CHECK(lttoolbox::seek_to_value(s.data(), last, index,
+                                         xs.size() + 1ull) == nullptr);
+  }
+
+  // Append the index to the values, as if it were inline.
+  const lttoolbox::BlockIndex index{s.data(), last};
+  std::ostringstream os{};
+  os.write(s.data(), last - s.data());
+  lttoolbox::encode_index(os, index);
+  const std::string t{os.str()};
+  const char *const t_last{t.data() + t.size()};
+  const char *const t_index{t.data() + (last - s.data())};
+
+  lttoolbox::BlockIndex decoded{};
+  BOOST_CHECK(lttoolbox::decode_index(t_index, t_last - 1, decoded) ==
+              t_index);
+  BOOST_CHECK_EQUAL(decoded.size(), 0ull);
+  BOOST_CHECK(lttoolbox::decode_index(t_index, t_last, decoded) == t_last);
+  BOOST_CHECK_EQUAL(decoded.size(), index.size());
+  BOOST_CHECK_EQUAL(decoded.block_size(), index.block_size());
+
+  const char *const first{
+      lttoolbox::seek_to_value(t.data(), t_index, decoded, 1000ull)};
+  std::uint64_t x{0ull};
+  BOOST_REQUIRE(first != nullptr);
+  lttoolbox::decode(first, t_index, x);
+  BOOST_CHECK_EQUAL(x, xs[1000ull]);
+
+  // A truncated value is not indexed.
+  BOOST_CHECK_EQUAL(lttoolbox::BlockIndex(s.data(), last - 1).size(),
+                    xs.size() - 1ull);
+}
+
+BOOST_AUTO_TEST_CASE(block_index_malformed) {
+  // Encode an index of `size` values in blocks of `block_size` with the given
+  // offsets, and then return whether it is decoded.
+  const auto test = [](const std::uint64_t block_size,
+                       const std::uint64_t size,
+                       const std::vector<std::uint64_t> &offsets) {
+    std::vector<char> s(9ull * (offsets.size() + 3ull));
+    char *last{lttoolbox::encode(s.data(), block_size)};
+    last = lttoolbox::encode(last, size);
+    last = lttoolbox::encode_delta(last, offsets.data(), offsets.size());
+    lttoolbox::BlockIndex index{};
+    return lttoolbox::decode_index(s.data(), last, index) == last;
+  };
+
+  BOOST_CHECK(test(2ull, 5ull, {0ull, 2ull, 4ull}));
+  BOOST_CHECK(test(~0ull, 5ull, {0ull}));
+
+  // The number of blocks must not be rounded up with an overflow.
+  BOOST_CHECK(!test(~0ull, 5ull, {}));
+  BOOST_CHECK(!test(0ull, 5ull, {}));
+  BOOST_CHECK(!test(2ull, 5ull, {0ull, 2ull}));
+
+  // The first block starts at 0, and each block holds `block_size` values.
+  BOOST_CHECK(!test(2ull, 5ull, {1ull, 3ull, 5ull}));
+  BOOST_CHECK(!test(2ull, 5ull, {0ull, 1ull, 4ull}));
+
+  // An offset past the end of the values is not followed.
+  const std::string t{"\x01\x02\x03\x04\x05"};
+  const char *const t_last{t.data() + t.size()};
+  std::vector<char> s(64ull);
+  char *last{lttoolbox::encode(s.data(), 2ull)};
+  last = lttoolbox::encode(last, 5ull);
+  const std::uint64_t offsets[]{0ull, 2ull, 0x100ull};
+  last = lttoolbox::encode_delta(last, offsets, 3ull);
+  lttoolbox::BlockIndex index{};
+  BOOST_REQUIRE(lttoolbox::decode_index(s.data(), last, index) == last);
+  BOOST_CHECK_EQUAL(index.block_count(), 3ull);
+  BOOST_CHECK_EQUAL(index.offset(3ull), ~std::size_t{0ull});
+  BOOST_CHECK(lttoolbox::seek_to_value(t.data(), t_last, index, 4ull) ==
+              nullptr);
+
+  std::uint64_t xs[5ull];
+  BOOST_CHECK(lttoolbox::decode_parallel(t.data(), t_last, index, xs) ==
+              t.data());
+}
+
+BOOST_AUTO_TEST_CASE(decode_parallel) {
+  // Enough values for several threads.
+  std::vector<std::uint64_t> xs{};
+
+  for (std::uint64_t seed{0xd0ull}; xs.size() < 200'000ull; ++seed) {
+    const std::vector<std::uint64_t> ys{generate_symbols(seed)};
+    xs.insert(xs.end(), ys.cbegin(), ys.cend());
+  }
+
+  std::vector<char> s(9ull * xs.size());
+  const char *const last{lttoolbox::encode_n(s.data(), xs.data(), xs.size())};
+  const lttoolbox::BlockIndex index{s.data(), last, 1000ull};
+
+  for (const std::size_t threads : {0ull, 1ull, 3ull, 8ull}) {
+    BOOST_TEST_CHECKPOINT(threads);
+    std::vector<std::uint64_t> decoded(xs.size());
+    std::size_t n{1ull};
+    BOOST_CHECK(lttoolbox::decode_parallel(s.data(), last, decoded.data(), n,
+                                           threads) == last);
+    BOOST_CHECK_EQUAL(n, 1ull + xs.size());
+    BOOST_CHECK(decoded == xs);
+
+    decoded.assign(xs.size(), 0ull);
+    BOOST_CHECK(lttoolbox::decode_parallel(s.data(), last, index,
+                                           decoded.data(), threads) == last);
+    BOOST_CHECK(decoded == xs);
+
+    // The last value is truncated.
+    n = 0ull;
+    BOOST_CHECK(lttoolbox::decode_parallel(s.data(), last - 1, decoded.data(),
+                                           n, threads) == s.data());
+    BOOST_CHECK_EQUAL(n, 0ull);
+  }
+
+  // Every byte after the first is 0x80, so the walks from odd and even bytes
+  // never meet, and each part must continue from where the last one ended.
+  {
+    std::vector<std::uint64_t> ys(300'001ull, 0x80ull);
+    ys.front() = 0x01ull;
+    std::vector<char> t(9ull * ys.size());
+    const char *const t_last{
+        lttoolbox::encode_n(t.data(), ys.data(), ys.size())};
+    BOOST_REQUIRE_EQUAL(t_last - t.data(), 600'001);
+    std::vector<std::uint64_t> decoded(ys.size());
+    std::size_t n{0ull};
+    BOOST_CHECK(lttoolbox::decode_parallel(t.data(), t_last, decoded.data(),
+                                           n, 8ull) == t_last);
+    BOOST_CHECK_EQUAL(n, ys.size());
+    BOOST_CHECK(decoded == ys);
+  }
+
+  // The index is of more values than the buffer holds.
+  std::vector<std::uint64_t> decoded(xs.size());
+  const char *const middle{s.data() + (last - s.data()) / 2};
+  BOOST_CHECK(lttoolbox::decode_parallel(s.data(), middle, index,
+                                         decoded.data(), 4ull) == s.data());
+}
+
+BOOST_AUTO_TEST_CASE(encoded_size) {
+  static_assert(lttoolbox::encoded_size(0x7full) == 1ull, "");
+  static_assert(lttoolbox::encoded_size(0x80ull) == 2ull, "");
+  static_assert(lttoolbox::encoded_size(0x3f'ffull) == 2ull, "");
+  static_assert(lttoolbox::encoded_size(0x40'00ull) == 3ull, "");
+  static_assert(lttoolbox::encoded_size(0xff'ff'ff'ff'ff'ff'ffull) == 8ull,
+                "");
+  static_assert(lttoolbox::encoded_size(0x01'00'00'00'00'00'00'00ull) == 9ull,
+                "");
+
+  for (const auto &x : generate_symbols(0xe0ull)) {
+    char s[9ull];
+    BOOST_CHECK_EQUAL(lttoolbox::encode(s, x) - s,
+                      lttoolbox::encoded_size(x));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(constexpr_encode_decode) {
+  static constexpr std::uint64_t xs[]{0x7full, 0x80ull, 0x10'08'04ull,
+                                      0xff'ff'ff'ff'ff'ff'ffull,
+                                      0xff'ff'ff'ff'ff'ff'ff'ffull};
+  static constexpr std::size_t size{lttoolbox::encoded_size(xs, xs + 5)};
+  static_assert(size == 1ull + 2ull + 3ull + 8ull + 9ull, "");
+  static constexpr auto s = lttoolbox::encode_array<size>(xs, xs + 5);
+  static constexpr auto ys = lttoolbox::decode_array<5ull>(s);
+  static_assert(ys[2ull] == xs[2ull] && ys[4ull] == xs[4ull], "");
+  static constexpr auto t = lttoolbox::encode_array<0x20'10ull>();
+  static_assert(t.size() == 2ull && t[0ull] == '\xa0' && t[1ull] == '\x10',
+                "");
+
+  BOOST_CHECK(std::equal(ys.cbegin(), ys.cend(), std::begin(xs)));
+
+  char u[9ull * 5ull];
+  char *last{u};
+
+  for (const auto &x : xs)
+    last = lttoolbox::encode(last, x);
+
+  BOOST_CHECK(std::equal<const char *>(u, last, s.cbegin(), s.cend()));
+}
+
+BOOST_AUTO_TEST_CASE(encode_parallel) {
+  std::vector<std::uint64_t> xs{};
+
+  for (std::uint64_t seed{0xf0ull}; xs.size() < 200'000ull; ++seed) {
+    const std::vector<std::uint64_t> ys{generate_symbols(seed)};
+    xs.insert(xs.end(), ys.cbegin(), ys.cend());
+  }
+
+  const std::size_t size{
+      lttoolbox::encoded_size(xs.data(), xs.data() + xs.size())};
+  std::vector<char> expected(9ull * xs.size());
+  expected.resize(lttoolbox::encode_n(expected.data(), xs.data(), xs.size()) -
+                  expected.data());
+  BOOST_REQUIRE_EQUAL(expected.size(), size);
+
+  // The bytes on either side of the values are not written.
+  for (const std::size_t threads : {0ull, 1ull, 3ull, 8ull}) {
+    BOOST_TEST_CHECKPOINT(threads);
+    std::vector<char> s(size + 2ull, '\x2a');
+    BOOST_CHECK(lttoolbox::encode_parallel(s.data() + 1, xs.data(),
+                                           xs.data() + xs.size(),
+                                           threads) == s.data() + 1 + size);
+    BOOST_CHECK(std::equal(s.cbegin() + 1, s.cend() - 1, expected.cbegin(),
+                           expected.cend()));
+    BOOST_CHECK(s.front() == '\x2a' && s.back() == '\x2a');
+  }
+
+  char s{'\x2a'};
+  BOOST_CHECK(lttoolbox::encode_parallel(&s, xs.data(), xs.data(), 4ull) ==
+              &s);
+  BOOST_CHECK_EQUAL(s, '\x2a');
+}
+
+BOOST_AUTO_TEST_CASE(delta) {
+  std::vector<std::uint64_t> xs{generate_symbols(0x80ull)};
+  std::partial_sum(xs.cbegin(), xs.cend(), xs.begin(),
+                   [](const std::uint64_t a, const std::uint64_t b) {
+                     return a + (b & 0xff'ffull);
+                   });
+  std::vector<char> s(9ull * (xs.size() + 1ull));
+  const char *const last{
+      lttoolbox::encode_delta(s.data(), xs.data(), xs.size())};
+
+  const auto kernels = get_kernels();
+
+  for (std::size_t i{0ull}; i != lttoolbox::kernel_count; ++i) {
+    const auto k = static_cast<lttoolbox::Kernel>(i);
+
+    if (!lttoolbox::set_kernel(k))
+      continue;
+
+    BOOST_TEST_CHECKPOINT(lttoolbox::get_name(k));
+    std::vector<std::uint64_t> decoded{0x2aull};
+    BOOST_CHECK(lttoolbox::decode_delta(s.data(), last, decoded) == last);
+    BOOST_CHECK_EQUAL(decoded.size(), 1ull + xs.size());
+    BOOST_CHECK(std::equal(decoded.cbegin() + 1, decoded.cend(),
+                           xs.cbegin()));
+  }
+
+  set_kernels(kernels);
+
+  lttoolbox::DeltaIterator it{s.data(), last};
+  BOOST_CHECK_EQUAL(it.size(), xs.size());
+  BOOST_CHECK(std::equal(it, lttoolbox::DeltaIterator{}, xs.cbegin()));
+
+  for (; it != lttoolbox::DeltaIterator{}; ++it)
+    ;
+
+  BOOST_CHECK(it.good());
+  BOOST_CHECK(it.tell() == last);
+}
+
+BOOST_AUTO_TEST_CASE(sorted_view) {
+  std::vector<std::uint64_t> xs{generate_symbols(0xa0ull)};
+  std::partial_sum(xs.cbegin(), xs.cend(), xs.begin(),
+                   [](const std::uint64_t a, const std::uint64_t b) {
+                     return a + (b & 0x0full);
+                   });
+  std::mt19937_64 engine{0xb0ull};
+
+  // The greatest block size holds every value in one block, and the block
+  // count must not wrap around to 0.
+  for (const std::size_t block_size : {1ull, 5ull, 128ull, ~0ull}) {
+    std::vector<char> s(lttoolbox::get_sorted_capacity(xs.size(), block_size));
+    const char *const last{
+        lttoolbox::encode_sorted(s.data(), xs.data(), xs.size(), block_size)};
+    const lttoolbox::SortedView view{s.data(), last};
+    BOOST_CHECK(view.good());
+    BOOST_CHECK_EQUAL(view.size(), xs.size());
+    BOOST_CHECK(view.tell() == last);
+
+    for (int i{0}; i != 1000; ++i) {
+      const std::uint64_t x{engine() % (xs.back() + 2ull)};
+      const std::size_t k = std::lower_bound(xs.cbegin(), xs.cend(), x) -
+                            xs.cbegin();
+      BOOST_CHECK_EQUAL(view.lower_bound(x), k);
+      BOOST_CHECK_EQUAL(view.contains(x),
+                        std::binary_search(xs.cbegin(), xs.cend(), x));
+
+      std::uint64_t y{0ull};
+      BOOST_CHECK_EQUAL(view.get(k, y), k != xs.size());
+      BOOST_CHECK(k == xs.size() || y == xs[k]);
+    }
+
+    BOOST_CHECK_EQUAL(view.lower_bound(0ull), 0ull);
+    BOOST_CHECK_EQUAL(view.lower_bound(xs.back()),
+                      std::lower_bound(xs.cbegin(), xs.cend(), xs.back()) -
+                          xs.cbegin());
+    BOOST_CHECK_EQUAL(view.lower_bound(xs.back() + 1ull), xs.size());
+
+    // The headers are truncated.
+    BOOST_CHECK(!lttoolbox::SortedView(s.data(), s.data() + 8).good());
+  }
+
+  std::array<char, lttoolbox::get_sorted_capacity(0ull, 4ull)> s{};
+  const lttoolbox::SortedView view{
+      s.data(), lttoolbox::encode_sorted(s.data(), nullptr, 0ull, 4ull)};
+  BOOST_CHECK(view.good());
+  BOOST_CHECK(view.empty());
+  BOOST_CHECK_EQUAL(view.lower_bound(0x2aull), 0ull);
+  BOOST_CHECK(!view.contains(0ull));
+}
+
+BOOST_AUTO_TEST_CASE(delta_unsorted_and_truncated) {
+  const std::array<std::uint64_t, 4ull> xs{
+      {0x10ull, 0x08ull, 0xff'ff'ff'ff'ff'ff'ff'ffull, 0x00ull}};
+  std::array<char, 9ull * (xs.size() + 1ull)> s{};
+  const char *const last{
+      lttoolbox::encode_delta(s.data(), xs.data(), xs.size())};
+
+  std::vector<std::uint64_t> decoded{};
+  BOOST_CHECK(lttoolbox::decode_delta(s.data(), last, decoded) == last);
+  BOOST_CHECK(std::equal(decoded.cbegin(), decoded.cend(), xs.cbegin(),
+                         xs.cend()));
+
+  decoded.clear();
+  BOOST_CHECK(lttoolbox::decode_delta(s.data(), last - 1, decoded) ==
+              s.data());
+  BOOST_CHECK(decoded.empty());
+
+  lttoolbox::DeltaIterator it{s.data(), last - 1};
+  std::size_t n{0ull};
+
+  for (; it != lttoolbox::DeltaIterator{}; ++it)
+    ++n;
+
+  BOOST_CHECK_EQUAL(n, xs.size() - 1ull);
+  BOOST_CHECK(!it.good());
+
+  // A count greater than the number of bytes left.
+  const std::array<char, 2ull> t{{'\x7f', '\x00'}};
+  BOOST_CHECK(lttoolbox::decode_delta(t.data(), t.data() + t.size(),
+                                      decoded) == t.data());
+}
+
+SmallStreambuf::SmallStreambuf(const std::string &s, const std::size_t size)
+    : s{s}, size{size}, i{0ull}, put{} {
+  setp(put, put + size);
+}
+
+auto SmallStreambuf::underflow() -> int_type {
+  if (i == s.size())
+    return traits_type::eof();
+
+  const std::size_t n{std::min(size, s.size() - i)};
+  setg(&s[i], &s[i], &s[i] + n);
+  i += n;
+  return traits_type::to_int_type(s[i - n]);
+}
+
+auto SmallStreambuf::overflow(const int_type c) -> int_type {
+  sync();
+
+  if (!traits_type::eq_int_type(c, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+
+  return traits_type::not_eof(c);
+}
+
+auto SmallStreambuf::sync() -> int {
+  s.append(pbase(), pptr());
+  setp(put, put + size);
+  return 0;
+}
+
 unsigned int ord(const char &c) { return static_cast<unsigned char>(c); }
 
 template <class InputIterator>
@@ -230,6 +1903,9 @@ template <std::size_t n>
 void test(const std::uint64_t x, const std::array<char, n> &s) {
   BOOST_CHECK(test_encode(x, s));
   BOOST_CHECK(test_decode(s, x));
+  BOOST_CHECK(test_encode_buffer(x, s));
+  BOOST_CHECK(test_decode_buffer(s, x));
+  BOOST_CHECK(test_decode_padded(s, x));
 }
 
 template <std::size_t n>
@@ -300,3 +1976,96 @@ bool test_decode(const std::array<char, n> &s, const std::uint64_t x) {
 
   return false;
 }
+
+template <std::size_t n>
+bool test_encode_buffer(const std::uint64_t x, const std::array<char, n> &s) {
+  char encoded[9ull];
+  const char *const last{lttoolbox::encode(encoded, x)};
+  return std::equal<const char *>(encoded, last, s.cbegin(), s.cend());
+}
+
+template <std::size_t n>
+bool test_decode_buffer(const std::array<char, n> &s, const std::uint64_t x) {
+  std::uint64_t decoded{0ull};
+  const char *const last{lttoolbox::decode(s.data(), s.data() + n, decoded)};
+  return last == s.data() + n && decoded == x;
+}
+
+// Return mostly values in the 0th and 1st classes, with runs of each long
+// enough to be decoded many at a time, and a few values in greater classes.
+// Check that the narrow overloads encode `x` as `s` and decode `s` as `x`.
+template <class T, std::size_t n>
+void test_narrow(const T x, const std::array<char, n> &s) {
+  char encoded[9ull];
+  const char *const last{lttoolbox::encode(encoded, x)};
+  BOOST_CHECK(std::equal<const char *>(encoded, last, s.cbegin(), s.cend()));
+
+  std::ostringstream os{};
+  lttoolbox::encode(os, x);
+  BOOST_CHECK(os.str() == std::string(s.data(), n));
+
+  T decoded{0};
+  BOOST_CHECK(lttoolbox::decode(s.data(), s.data() + n, decoded) ==
+              s.data() + n);
+  BOOST_CHECK(decoded == x);
+
+  std::istringstream is{{s.data(), n}};
+  decoded = 0;
+  BOOST_CHECK(lttoolbox::decode(is, decoded));
+  BOOST_CHECK(decoded == x);
+}
+
+auto get_kernels()
+    -> std::array<lttoolbox::Kernel, lttoolbox::operation_count> {
+  std::array<lttoolbox::Kernel, lttoolbox::operation_count> kernels;
+
+  for (std::size_t i{0ull}; i != kernels.size(); ++i)
+    kernels[i] = lttoolbox::get_kernel(static_cast<lttoolbox::Operation>(i));
+
+  return kernels;
+}
+
+void set_kernels(
+    const std::array<lttoolbox::Kernel, lttoolbox::operation_count> &kernels) {
+  for (std::size_t i{0ull}; i != kernels.size(); ++i)
+    lttoolbox::set_kernel(static_cast<lttoolbox::Operation>(i), kernels[i]);
+}
+
+auto generate_symbols(const std::uint64_t seed) -> std::vector<std::uint64_t> {
+  std::mt19937_64 engine{seed};
+  std::vector<std::uint64_t> xs{};
+
+  for (int run{0}; run != 512; ++run) {
+    const std::uint64_t length{engine() % 48ull};
+    const std::uint64_t kind{engine() % 8ull};
+
+    for (std::uint64_t i{0ull}; i != length; ++i) {
+      switch (kind) {
+      case 0ull:
+      case 1ull:
+      case 2ull:
+        xs.push_back(engine() % 0x80ull);
+        break;
+      case 3ull:
+        xs.push_back(0x80ull + engine() % (0x40'00ull - 0x80ull));
+        break;
+      case 4ull:
+        xs.push_back(engine() % 0x40'00ull);
+        break;
+      default:
+        xs.push_back(engine() >> (engine() % 64ull));
+      }
+    }
+  }
+
+  return xs;
+}
+
+template <std::size_t n>
+bool test_decode_padded(const std::array<char, n> &s, const std::uint64_t x) {
+  const lttoolbox::PaddedBuffer padded{s.cbegin(), s.cend()};
+  std::uint64_t decoded{0ull};
+  const char *const last{
+      lttoolbox::decode_padded(padded.begin(), padded.end(), decoded)};
+  return last == padded.end() && decoded == x;
+}
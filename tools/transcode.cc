@@ -0,0 +1,76 @@
+// This file is part of io.
+//
+// io is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// io is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with io.  If not, see <http://www.gnu.org/licenses/>.
+
+// Convert a file of values between Apertium binary format and group blocks;
+// see group_varint.h.
+//
+//   transcode --to-group [INPUT [OUTPUT]]
+//   transcode --from-group [INPUT [OUTPUT]]
+//
+// INPUT and OUTPUT default to the standard input and output.  The values are
+// converted a block at a time, so files of any size take constant memory.  To
+// upgrade a file, write to another file and then rename it over the original.
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "group_varint.h"
+
+int main(int argc, char **argv) {
+  if (argc < 2 || argc > 4 || (std::strcmp(argv[1], "--to-group") != 0 &&
+                               std::strcmp(argv[1], "--from-group") != 0)) {
+    std::cerr << "usage: " << argv[0]
+              << " (--to-group | --from-group) [INPUT [OUTPUT]]\n";
+    return 2;
+  }
+
+  std::ios::sync_with_stdio(false);
+  std::cin.tie(nullptr);
+  std::ifstream input_file{};
+  std::ofstream output_file{};
+
+  if (argc >= 3) {
+    input_file.open(argv[2], std::ios::binary);
+
+    if (!input_file) {
+      std::cerr << argv[0] << ": cannot open " << argv[2] << '\n';
+      return 1;
+    }
+  }
+
+  if (argc == 4) {
+    output_file.open(argv[3], std::ios::binary);
+
+    if (!output_file) {
+      std::cerr << argv[0] << ": cannot open " << argv[3] << '\n';
+      return 1;
+    }
+  }
+
+  std::istream &is{argc >= 3 ? input_file : std::cin};
+  std::ostream &os{argc == 4 ? output_file : std::cout};
+  const bool good{std::strcmp(argv[1], "--to-group") == 0
+                      ? lttoolbox::transcode_to_group(is, os)
+                      : lttoolbox::transcode_from_group(is, os)};
+
+  if (!good) {
+    std::cerr << argv[0] << ": input is truncated or malformed, or output "
+              << "failed\n";
+    return 1;
+  }
+
+  return 0;
+}